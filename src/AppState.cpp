@@ -38,13 +38,14 @@ ReaderFactory::ReaderFactory() {
                    std::make_unique<LengthPrefixedStringReader<int32_t>>());
 }
 
-bool ReaderFactory::read(AppState &state, const std::string &type) const {
+bool ReaderFactory::read(AppState &state, const std::string &type,
+                         size_t count) const {
   auto it = readers_.find(type);
   if (Utils::is_char_array_type(type)) {
     it = readers_.find("fixstring");
   }
   if (it != readers_.end()) {
-    return it->second->read(state, type);
+    return it->second->read(state, type, count);
   }
   return false;
 }
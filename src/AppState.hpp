@@ -1,25 +1,36 @@
 #pragma once
 
-#include <any>
+#include <atomic>
 #include <cstdint>
 #include <filesystem>
 #include <fmt/format.h>
+#include <functional>
 #include <ftxui/component/component.hpp>
 #include <ftxui/component/screen_interactive.hpp>
 #include <ftxui/dom/elements.hpp>
 #include <iomanip>
 #include <istream>
 #include <memory>
+#include <optional>
 #include <ostream>
 #include <sstream>
-#include <stack>
 #include <string>
 #include <type_traits>
 #include <typeindex>
 #include <unordered_map>
 #include <vector>
 
+#include "BlockStats.hpp"
+#include "ByteSwap.hpp"
 #include "Command.hpp"
+#include "ConcatSource.hpp"
+#include "DataSource.hpp"
+#include "FileWatcher.hpp"
+#include "InputBatcher.hpp"
+#include "Prefetcher.hpp"
+#include "ProcMemSource.hpp"
+#include "ReadHistory.hpp"
+#include "Schema.hpp"
 #include "Utils.hpp"
 
 using namespace ftxui;
@@ -111,48 +122,162 @@ public:
   }
 };
 
-// ========== Record ==========
-/// 记录一次读取操作：记录读取位置 + 读到的数据 + 类型名称
-struct Record {
-  size_t index;                          // 读取起始位置
-  std::any data;                         // 存储任何类型的数据
-  std::string type_name = std::string(); // 类型名称
-
-  template <typename T>
-  Record(size_t idx, T value) : index(idx), data(std::move(value)) {}
-
-  /// 格式化成 “<8 位十六进制地址>:<类型名>:<数据>”
-  std::string description() const {
-    std::stringstream ss;
-    ss << std::hex << std::setw(8) << std::setfill('0') << index << ":"
-       << type_name << ":";
-    // 用户可以根据 type_name 再 any_cast 到相应类型并格式化输出
-    return ss.str();
-  }
-};
-
 // ========== AppState ==========
 /// 保存整个程序的状态，以及各种读/写、光标移动逻辑
 struct AppState {
-  std::vector<uint8_t> data;  // 原始文件的二进制数据
+  DataBuffer data;            // 文件数据（mmap 或内存数据源）
   size_t cursor_pos = 0;      // 当前光标位置（字节索引）
   size_t bytes_per_line = 16; // 每行显示的字节数
   size_t current_page = 0;    // 当前页号（从 0 开始）
   size_t hex_view_h = 16; // Hex 视图高度：每页最多显示 hex_view_h 行
+  bool smooth_scroll = false; // 平滑滚动：视口按行移动，不对齐到页边界
+  size_t top_line = 0;        // 平滑滚动时视口第一行的行号
+  bool auto_fit = true;       // 按终端大小自动计算每行字节数与行数
+  bool fit_pow2 = true;       // 自动计算时每行字节数取 2 的幂
+  bool show_minimap = true;   // 在 Hex 视图旁显示整个文件的概览小地图
+  bool byte_colors = true;    // Hex 视图按字节类别着色
   std::string status_msg;          // 状态栏文字
   bool is_little_endian = true;    // 默认小端序
-  std::stack<Record> read_history; // 保存所有已读取的记录以便 undo
+  ReadHistory read_history;        // 读取日志（当前分支最早→最晚），用于 undo/redo
+  size_t history_scroll = 0; // 历史面板从最新记录向上滚动的条数（0 = 跟随最新）
+  std::unordered_map<std::string, StructPlan> schemas; // 已编译的 struct 定义
   Command last_command;            // 最近一次执行的命令
 
   std::string file_name;       // 当前打开的文件名
+  std::string file_path;       // 当前打开文件的路径
   bool exit_requested = false; // 是否请求退出
 
-  /// 从磁盘加载整个文件到 data 中，并初始化 cursor/page
-  void load_file(const std::string &path) {
-    data = Utils::read_binary_file(path);
-    file_name = std::filesystem::path(path).filename().string();
+  bool follow_tail = false;             // follow 模式下是否自动滚动到末尾
+  std::unique_ptr<FileWatcher> watcher; // follow 模式的文件监视器
+  Prefetcher prefetcher;                // 按滚动方向异步预读后续页面
+  InputBatcher input;                   // 合并两帧之间的导航命令
+  bool batch_navigation = false; // 导航命令留到绘制前执行（由 UI 设置）
+
+  /// 把任务投递到 UI 线程执行（main 中设置为 screen.Post）；未设置时直接执行
+  std::function<void(std::function<void()>)> post_task;
+
+  static constexpr size_t kMinimapCells = 1024; // 小地图把数据分成的块数
+  /// 小地图的块统计（后台线程计算，进度通过 post_task 触发重绘）；
+  /// 声明在 post_task 之后，析构时先停止计算线程
+  std::unique_ptr<BlockStats> block_stats;
+
+  AppState() = default;
+  AppState(const AppState &) = delete;
+  AppState &operator=(const AppState &) = delete;
+  /// 先停止监视线程，避免其回调访问正在析构的成员
+  ~AppState() { stop_follow(); }
+
+  /// 打开文件作为数据源（优先 mmap，不拷贝内容），并初始化 cursor/page
+  void load_file(const std::string &path, const OpenOptions &options = {}) {
+    stop_follow();
+    data.reset(open_data_source(path, options));
+    // 进程内存没有可以监视追加的文件
+    file_path = ProcMemSource::parse_pid(path) ? std::string() : path;
+    file_name = path == "-" ? "<stdin>"
+                            : std::filesystem::path(path).filename().string();
+    cursor_pos = 0;
+    current_page = 0;
+    top_line = 0;
+    prefetcher.reset();
+    // 字符串记录引用的是旧数据中的位置
+    read_history.clear();
+    history_scroll = 0;
+  }
+
+  /// 打开多个文件并按顺序拼接为一个地址空间（各文件在首次访问时才打开）；
+  /// 只有一个文件时等同于 load_file
+  void load_files(const std::vector<std::string> &paths,
+                  const OpenOptions &options = {}) {
+    if (paths.size() == 1) {
+      load_file(paths.front(), options);
+      return;
+    }
+    auto source = ConcatSource::open(paths, options);
+    if (!source)
+      throw std::runtime_error("Failed to open files for concatenation");
+    stop_follow();
+    data.reset(std::move(source));
+    // 拼接后没有单一的文件可以 follow
+    file_path.clear();
+    file_name = fmt::format(
+        "{} (+{} files)", std::filesystem::path(paths.front()).filename().string(),
+        paths.size() - 1);
     cursor_pos = 0;
     current_page = 0;
+    top_line = 0;
+    prefetcher.reset();
+    // 字符串记录引用的是旧数据中的位置
+    read_history.clear();
+    history_scroll = 0;
+  }
+
+  /// 把数据源报告的读取错误（见 DataSource::take_error）移到状态栏；
+  /// 状态栏每次绘制前调用
+  void show_source_error() {
+    if (std::string error = data.take_error(); !error.empty())
+      status_msg = std::move(error);
+  }
+
+  /// 光标所在的命名区段（单个文件或不在任何区段中时为 nullptr）
+  [[nodiscard]] const Segment *segment_at(size_t pos) const {
+    const auto *segments = data.segments();
+    if (!segments || segments->empty())
+      return nullptr;
+    auto it = std::upper_bound(
+        segments->begin(), segments->end(), pos,
+        [](size_t p, const Segment &seg) { return p < seg.offset; });
+    if (it == segments->begin())
+      return nullptr;
+    // 区段之间可能有空洞（进程的未映射地址）
+    const Segment &seg = *std::prev(it);
+    return pos < seg.offset + seg.length ? &seg : nullptr;
+  }
+
+  /// 重新检查文件大小，只扩展新增部分；follow_tail 时光标跟随到末尾。
+  /// modified 表示监视方报告了写入（已有内容可能被原地修改）。
+  /// 返回新增的字节数；扩展失败时写入 status_msg 并返回 0
+  size_t refresh_data(bool modified = false) {
+    size_t added = 0;
+    try {
+      added = data.refresh(modified);
+    } catch (const std::exception &e) {
+      status_msg = fmt::format("Follow: {}", e.what());
+      return 0;
+    }
+    if (added > 0 && follow_tail)
+      set_cursor_pos(data.size() - 1);
+    return added;
+  }
+
+  /// 开启 follow 模式：监视文件追加，并在 UI 线程上增量刷新数据
+  bool start_follow(bool tail) {
+    follow_tail = tail;
+    if (!watcher) {
+      if (file_path.empty())
+        return false;
+      watcher = std::make_unique<FileWatcher>(file_path, [this] {
+        // 上一次刷新还未执行时不重复投递，突发写入只刷新一次
+        if (refresh_pending_.exchange(true))
+          return;
+        auto task = [this] {
+          refresh_pending_.store(false);
+          if (refresh_data(true) > 0)
+            status_msg = fmt::format("Follow: {} bytes", data.size());
+        };
+        if (post_task)
+          post_task(task);
+        else
+          task();
+      });
+    }
+    refresh_data();
+    return true;
+  }
+
+  /// 关闭 follow 模式
+  void stop_follow() {
+    watcher.reset();
+    follow_tail = false;
   }
 
   /// 计算总页数：等于 ceil(total_lines / hex_view_h)
@@ -165,44 +290,75 @@ struct AppState {
     return (total_lines + lines_per_page - 1) / lines_per_page;
   }
 
-  void apply_command(const Command &cmd) {
+  /// 执行导航命令 count 次；光标移动一次算出最终位置，只更新一次页面
+  void apply_command(const Command &cmd, size_t count = 1) {
+    const size_t last = data.empty() ? 0 : data.size() - 1;
     switch (cmd.type) {
     case CommandType::MoveUp:
-      pre_line();
+      if (cursor_pos >= bytes_per_line)
+        set_cursor_pos(cursor_pos -
+                       std::min(count, cursor_pos / bytes_per_line) *
+                           bytes_per_line);
       break;
     case CommandType::MoveDown:
-      next_line();
+      if (cursor_pos + bytes_per_line < data.size())
+        set_cursor_pos(cursor_pos +
+                       std::min(count, (last - cursor_pos) / bytes_per_line) *
+                           bytes_per_line);
       break;
     case CommandType::MoveLeft:
-      pre();
+      if (cursor_pos > 0)
+        set_cursor_pos(cursor_pos - std::min(count, cursor_pos));
       break;
     case CommandType::MoveRight:
-      next();
+      if (cursor_pos < last)
+        set_cursor_pos(cursor_pos + std::min(count, last - cursor_pos));
       break;
     case CommandType::PageUp:
-      pre_page();
+      for (size_t i = 0; i < count; ++i)
+        if (!pre_page())
+          break;
       break;
     case CommandType::PageDown:
-      next_page();
+      for (size_t i = 0; i < count; ++i)
+        if (!next_page())
+          break;
       break;
     case CommandType::ReadByte:
     case CommandType::None:
     case CommandType::Jump:
       break;
     }
+    // 根据滚动方向与速度提示数据源预读接下来的页面，翻页时不再等待 I/O
+    const size_t page_bytes = std::max<size_t>(1, hex_view_h) * bytes_per_line;
+    if (auto ahead = prefetcher.observe(cmd.type, view_start(), page_bytes,
+                                        data.size()))
+      data.advise(ahead->offset, ahead->length);
+  }
+
+  /// 把导航命令放入批次，由绘制前的 flush_commands 统一执行（按住方向键时
+  /// 每帧合并为一次移动）；batch_navigation 为 false 时立即执行
+  void queue_command(const Command &cmd) {
+    input.push(cmd.type);
+    if (!batch_navigation)
+      flush_commands();
+  }
+
+  /// 立即执行批次中累计的导航命令（每帧绘制前、执行其他命令前调用，
+  /// 保证看到的是最新的光标）
+  void flush_commands() {
+    for (const auto &run : input.take())
+      apply_command(Command{run.type}, run.count);
   }
 
   // —— 通用读取/移动 接口 —— //
 
   /// 〈peek〉：在 pos 处“窥视”一个 T 类型的数据，但不移动光标
   template <typename T> T peek(size_t pos) const {
-    if (pos + sizeof(T) > data.size()) {
-      throw std::out_of_range("Attempt to read beyond data bounds");
-    }
     T value;
-    std::memcpy(&value, &data[pos], sizeof(T));
+    data.copy(pos, &value, sizeof(T));
     if (!is_little_endian) {
-      reverse_bytes(reinterpret_cast<uint8_t *>(&value), sizeof(T));
+      byteswap_array(reinterpret_cast<uint8_t *>(&value), sizeof(T), 1);
     }
     return value;
   }
@@ -211,58 +367,98 @@ struct AppState {
   /// history；光标向前移动 sizeof(T) 字节
   template <typename T> T read(size_t pos) {
     T value = peek<T>(pos);
-    auto record = Record{pos, value};
-    record.type_name = fmt::format("{}", TypeFactory::getTypeShortName<T>());
-    read_history.push(record);
+    read_history.push(pos, value);
     move(sizeof(T));
     return value;
   }
 
-  /// 从 pos 处读取固定长度字符串（长度为 n），并推入 history；光标向前移动 n
-  std::string read_fixed_string(size_t pos, size_t n) {
-    if (pos + n > data.size()) {
-      throw std::out_of_range("Read operation exceeds data size");
-    }
-    std::string str(data.begin() + pos, data.begin() + pos + n);
+  /// 从 pos 处一次读取 count 个 T：整段拷贝后（大端时）整段转换字节序，
+  /// 作为一条 T[count] 记录推入 history；光标向前移动 count * sizeof(T)
+  template <typename T> std::vector<T> read_array(size_t pos, size_t count) {
+    // 已知越界时不必先分配（仍在加载时交给 copy 抛出 DataPendingError）
+    const size_t avail = data.size() - std::min(pos, data.size());
+    if (count > SIZE_MAX / sizeof(T) ||
+        (!data.loading() && count > avail / sizeof(T)))
+      throw std::out_of_range("read past end of data");
+    std::vector<T> values(count);
+    data.copy(pos, values.data(), count * sizeof(T));
+    if (!is_little_endian)
+      byteswap_array(reinterpret_cast<uint8_t *>(values.data()), sizeof(T),
+                     count);
+    read_history.push_array(pos, values.data(), count);
+    move(count * sizeof(T));
+    return values;
+  }
+
+  /// 从 pos 处读取固定长度字符串（长度为 n），并推入 history；光标向前移动 n。
+  /// 不拷贝内容：返回值只是数据中的位置，需要文本时用 text() 取出；
+  /// 数据可能变化时 history 另存一段有上限的预览（见 push_string）
+  ByteSpan read_fixed_string(size_t pos, size_t n) {
+    // 越界时抛出 std::out_of_range（仍在加载时抛出 DataPendingError）
+    data.require(pos, n);
     move(n);
-    auto record = Record{pos, str};
-    record.type_name = fmt::format("char[{}]", n);
-    read_history.push(record);
-    return str;
+    const ByteSpan span{pos, n};
+    push_string(pos, fmt::format("char[{}]", n), span);
+    return span;
   }
 
   /// 从 pos 处读取“长度前缀字符串”：先读一个 LengthType
-  /// 长度，然后再读对应字节数的字符串
+  /// 长度，然后再读对应字节数的字符串；“长度前缀”和“字符串”作为一条记录
   template <typename LengthType>
-  std::string read_length_prefixed_string(size_t pos) {
+  ByteSpan read_length_prefixed_string(size_t pos) {
     const size_t start_pos = cursor_pos;
-    try {
-      LengthType len =
-          read<LengthType>(pos); // 已经把 cursor_pos += sizeof(LengthType)
-      std::string str = read_fixed_string(pos + sizeof(LengthType), len);
-      // 因为我们想把“长度前缀”和“字符串”当作一个整体记录，所以先弹出它们，再合并成一个
-      read_history.pop(); // 弹出固定字符串那条
-      read_history.pop(); // 弹出长度前缀那条
-      auto record = Record{start_pos, str};
-      record.type_name =
-          fmt::format("string@{}", TypeFactory::getTypeShortName<LengthType>());
-      read_history.push(record);
-      return str;
-    } catch (...) {
-      cursor_pos = start_pos; // 恢复光标
-      throw;
+    const auto len = static_cast<size_t>(peek<LengthType>(pos));
+    const ByteSpan span{pos + sizeof(LengthType), len};
+    // 检查通过之前不改动光标和历史
+    data.require(span.offset, span.length);
+    push_string(start_pos,
+                "string@" + TypeFactory::getTypeShortName<LengthType>(), span);
+    move(sizeof(LengthType) + len);
+    return span;
+  }
+
+  /// 取出数据中的一段文本（最多 max_chars 个字节）
+  [[nodiscard]] std::string text(const ByteSpan &span,
+                                 size_t max_chars = SIZE_MAX) const {
+    return ReadHistory::text(data, span, max_chars);
+  }
+
+  /// 加载 schema 文件中的 struct 定义（同名的覆盖旧定义），返回定义数
+  size_t load_schema(const std::string &path) {
+    std::vector<StructPlan> plans = load_schema_file(path);
+    for (auto &plan : plans) {
+      std::string name = plan.name;
+      schemas.insert_or_assign(std::move(name), std::move(plan));
     }
+    return plans.size();
+  }
+
+  /// 从 pos 处连续应用 count 条名为 name 的 struct，每个字段各记一条历史；
+  /// 返回读取的字节数。未定义时抛出 std::invalid_argument
+  size_t apply_struct(const std::string &name, size_t pos, size_t count = 1) {
+    const auto it = schemas.find(name);
+    if (it == schemas.end())
+      throw std::invalid_argument("Unknown struct: " + name);
+    return it->second.apply(*this, pos, count);
   }
 
-  /// 撤销最近一次读取：弹出 read_history，并把 cursor_pos 恢复到该记录的 index
+  /// 撤销最近一次读取：read_history 的 head 退回父记录，并把 cursor_pos
+  /// 恢复到该记录的 index（记录仍留在日志中，可以 redo）
   void undo() {
     if (!read_history.empty()) {
-      Record record = read_history.top();
-      set_cursor_pos(record.index);
-      read_history.pop();
+      set_cursor_pos(read_history.back().index);
+      read_history.undo();
     }
   }
 
+  /// 重做最近撤销的读取：head 前进到 redo 目标，cursor_pos 移到该记录读完的位置
+  bool redo() {
+    if (!read_history.redo())
+      return false;
+    set_cursor_pos(read_history.end_of(read_history.size() - 1));
+    return true;
+  }
+
   /// 直接设置光标位置（如果 new_pos <= data.size()），并更新 current_page
   bool set_cursor_pos(size_t new_pos) {
     if (new_pos <= data.size()) {
@@ -324,68 +520,281 @@ struct AppState {
     return false;
   }
 
-  /// 更新 current_page = floor(cursor_pos / (bytes_per_line * hex_view_h))
+  /// 更新 current_page = floor(cursor_pos / (bytes_per_line * hex_view_h))；
+  /// 平滑滚动时只在光标离开视口时把视口最少地移动到包含光标
   void update_page() {
+    if (smooth_scroll) {
+      const size_t line = cursor_pos / bytes_per_line;
+      const size_t rows = std::max<size_t>(1, hex_view_h);
+      if (line < top_line)
+        top_line = line;
+      else if (line >= top_line + rows)
+        top_line = line - rows + 1;
+      current_page = top_line / rows;
+      return;
+    }
     current_page = (cursor_pos / bytes_per_line) / hex_view_h;
   }
 
-  /// 下一页：页号加一，并把 cursor_pos 跳到该页开头
+  /// 地址列的十六进制位数：按最大地址统一，至少 8 位
+  [[nodiscard]] size_t address_digits() const {
+    const size_t last = data.empty() ? 0 : data.size() - 1;
+    size_t digits = 8;
+    while (digits < 16 && (last >> (4 * digits)) != 0)
+      ++digits;
+    return digits;
+  }
+
+  /// 按 Hex 视图内部可用的列数与行数重新计算 bytes_per_line 与 hex_view_h。
+  /// 光标所在的字节不变，平滑滚动时还尽量保持在屏幕上的同一行；
+  /// 返回是否有变化
+  bool fit_view(size_t cols, size_t rows) {
+    // 每字节占 "XX " 3 列与 ASCII 1 列，另有地址、": " 与分隔线
+    const size_t fixed = address_digits() + 2 + 1;
+    size_t bpl = cols > fixed + 4 ? (cols - fixed) / 4 : 1;
+    if (fit_pow2) {
+      size_t pow2 = 1;
+      while (pow2 * 2 <= bpl)
+        pow2 *= 2;
+      bpl = pow2;
+    }
+    const size_t h = std::max<size_t>(1, rows);
+    if (bpl == bytes_per_line && h == hex_view_h)
+      return false;
+
+    if (smooth_scroll) {
+      // 光标在视口中的行保持不变（按旧的行宽计算）
+      const size_t screen_row = cursor_pos / bytes_per_line - top_line;
+      const size_t line = cursor_pos / bpl;
+      top_line = line - std::min(line, std::min(screen_row, h - 1));
+    }
+    bytes_per_line = bpl;
+    hex_view_h = h;
+    update_page();
+    return true;
+  }
+
+  /// 视口第一行的起始偏移
+  [[nodiscard]] size_t view_start() const {
+    return (smooth_scroll ? top_line : current_page * hex_view_h) *
+           bytes_per_line;
+  }
+
+  /// 切换平滑滚动；开启时视口从当前页开始，关闭时回到光标所在的页
+  void set_smooth_scroll(bool on) {
+    if (on && !smooth_scroll)
+      top_line = current_page * hex_view_h;
+    smooth_scroll = on;
+    update_page();
+  }
+
+  /// 下一页：页号加一，并把 cursor_pos 跳到该页开头；
+  /// 整页都是空洞时直接跳到空洞之后的数据
   bool next_page() {
+    if (smooth_scroll)
+      return scroll_lines(hex_view_h, true);
     size_t tp = total_pages();
     if (current_page + 1 < tp) {
       ++current_page;
       cursor_pos = current_page * bytes_per_line * hex_view_h;
+      if (auto hole = page_hole(); hole && hole->end() < data.size())
+        set_cursor_pos(hole->end());
       return true;
     }
     return false;
   }
 
-  /// 上一页
+  /// 上一页；整页都是空洞时跳到空洞之前最后一段数据所在的页
   bool pre_page() {
+    if (smooth_scroll)
+      return scroll_lines(hex_view_h, false);
     if (current_page > 0) {
       --current_page;
       cursor_pos = current_page * bytes_per_line * hex_view_h;
+      if (auto hole = page_hole(); hole && hole->offset > 0) {
+        set_cursor_pos(hole->offset - 1);
+        cursor_pos = current_page * bytes_per_line * hex_view_h;
+      }
       return true;
     }
     return false;
   }
 
-  /// 将 read_history 中所有 Record 按照“最早→最晚”的顺序返回一个 vector
-  std::vector<Record> get_read_history() const {
-    std::vector<Record> history;
-    auto temp = read_history;
-    while (!temp.empty()) {
-      history.insert(history.begin(), temp.top());
-      temp.pop();
+  /// 平滑滚动：视口与光标一起移动 lines 行（光标保持在视口中的相对位置）；
+  /// 整屏都是空洞时直接越过空洞
+  bool scroll_lines(size_t lines, bool down) {
+    if (data.empty())
+      return false;
+    const size_t rows = std::max<size_t>(1, hex_view_h);
+    const size_t total_lines = (data.size() + bytes_per_line - 1) / bytes_per_line;
+    const size_t max_top = total_lines > rows ? total_lines - rows : 0;
+    const size_t line = cursor_pos / bytes_per_line;
+    size_t target = line;
+    if (down) {
+      if (line + 1 >= total_lines)
+        return false;
+      target = std::min(line + lines, total_lines - 1);
+      top_line = std::min(top_line + (target - line), max_top);
+    } else {
+      if (line == 0)
+        return false;
+      target = line - std::min(lines, line);
+      top_line -= std::min(top_line, line - target);
+    }
+    cursor_pos = std::min(target * bytes_per_line + cursor_pos % bytes_per_line,
+                          data.size() - 1);
+    if (auto hole = page_hole()) {
+      if (down && hole->end() < data.size()) {
+        cursor_pos = hole->end();
+        top_line = std::min(cursor_pos / bytes_per_line, max_top);
+      } else if (!down && hole->offset > 0) {
+        cursor_pos = hole->offset - 1;
+        const size_t at = cursor_pos / bytes_per_line;
+        top_line = at + 1 > rows ? at + 1 - rows : 0;
+      }
+    }
+    update_page();
+    return true;
+  }
+
+  /// 跳到下一个数据区段的起点（稀疏文件），O(log 区段数)
+  bool next_data() {
+    auto extents = data.extents();
+    if (!extents)
+      return false;
+    auto pos = extents->next_data(cursor_pos);
+    return pos && *pos < data.size() && set_cursor_pos(*pos);
+  }
+
+  /// 跳到上一个数据区段的起点
+  bool prev_data() {
+    auto extents = data.extents();
+    if (!extents)
+      return false;
+    auto pos = extents->prev_data(cursor_pos);
+    return pos && set_cursor_pos(*pos);
+  }
+
+  /// read_history 中所有记录（最早→最晚），不拷贝
+  const ReadHistory &get_read_history() const { return read_history; }
+
+  /// 历史面板可见的记录区间 [first, last)：高度为 rows，
+  /// 末尾为最新记录之前 history_scroll 条处
+  [[nodiscard]] std::pair<size_t, size_t> history_window(size_t rows) const {
+    const size_t total = read_history.size();
+    // 滚到顶时仍显示满一屏
+    const size_t last = std::max(total - std::min(history_scroll, total),
+                                 std::min(rows, total));
+    return {last - std::min(rows, last), last};
+  }
+
+  /// 历史面板向上（delta > 0）或向下滚动，滚动范围限制在记录数之内
+  void scroll_history(long delta) {
+    const size_t total = read_history.size();
+    history_scroll = std::min(history_scroll, total);
+    // 先与剩余范围比较再相加，-LONG_MIN 也不溢出
+    if (delta >= 0)
+      history_scroll +=
+          std::min(static_cast<size_t>(delta), total - history_scroll);
+    else
+      history_scroll -= std::min(
+          history_scroll, static_cast<size_t>(-(delta + 1)) + 1);
+  }
+
+  /// 当前数据的块统计：数据源替换、刷新或加载完成后重新开始计算。
+  /// 同一数据源在末尾增长时（follow）沿用旧范围内各块的结果，只计算
+  /// 新增部分；仍在加载且还没有结果时返回 nullptr
+  const BlockStats *minimap_stats() {
+    const bool stale = !block_stats ||
+                       block_stats_generation_ != data.generation() ||
+                       block_stats->data_size() != data.size();
+    if (stale && !data.empty() && !data.loading()) {
+      const bool grown = block_stats &&
+                         block_stats->source() == data.source() &&
+                         block_stats->data_size() < data.size();
+      auto next = std::make_unique<BlockStats>(
+          data.shared_source(), std::min(kMinimapCells, data.size()),
+          [this] {
+            // 只需让界面重绘一次
+            if (post_task)
+              post_task([] {});
+          },
+          0, grown ? block_stats.get() : nullptr);
+      block_stats = std::move(next); // 旧的计算线程在析构时停止
+      block_stats_generation_ = data.generation();
     }
-    return history;
+    // 新数据还在加载时不显示旧数据的结果
+    return block_stats && block_stats_generation_ == data.generation()
+               ? block_stats.get()
+               : nullptr;
+  }
+
+  /// 点击小地图第 row 行（共 rows 行）：跳到该行所代表的第一个块的起点
+  bool minimap_jump(size_t row, size_t rows) {
+    const BlockStats *stats = minimap_stats();
+    if (!stats || rows == 0 || row >= rows)
+      return false;
+    const size_t pos = stats->cell_offset(row * stats->cells() / rows);
+    if (!set_cursor_pos(std::min(pos, data.size() - 1)))
+      return false;
+    status_msg = fmt::format("Jumped to block at 0x{:x}", cursor_pos);
+    return true;
   }
 
 private:
-  /// 将指针指向的 T 类型的“字节数组”做大小端颠倒
-  void reverse_bytes(uint8_t *bytes, size_t size) const {
-    for (size_t i = 0; i + 1 < size - i; ++i) {
-      std::swap(bytes[i], bytes[size - 1 - i]);
+  std::atomic<bool> refresh_pending_{false}; // 是否已有待执行的刷新任务
+  uint64_t block_stats_generation_ = 0;     // block_stats 对应的数据版本
+
+  /// 把字符串记入 history：数据不会再变时只记位置；live 的数据源或可能被
+  /// 原地改写的文件上另存开头的一段预览（至多 kPreviewChars 个字节），
+  /// 历史显示读取时的内容，拷贝量与字符串长度无关
+  void push_string(size_t offset, const std::string &type, ByteSpan span) {
+    if (data.immutable()) {
+      read_history.push_chars(
+          offset, read_history.intern(type, ReadHistory::Kind::Chars), span);
+      return;
     }
+    read_history.push_text(offset,
+                           read_history.intern(type, ReadHistory::Kind::Text),
+                           span, data);
+  }
+
+  /// 从 cursor_pos 开始的整页都落在同一个空洞中时返回该空洞
+  std::optional<Extent> page_hole() const {
+    auto extents = data.extents();
+    if (!extents)
+      return std::nullopt;
+    auto hole = extents->hole_at(cursor_pos);
+    if (hole && hole->end() - cursor_pos >= bytes_per_line * hex_view_h)
+      return hole;
+    return std::nullopt;
   }
 };
 
 // ========== ReaderStrategy 抽象基类 ==========
-/// 定义一个虚函数 `bool read(AppState&)`，由子类实现具体读取逻辑
+/// 定义一个虚函数 `bool read(AppState&, type, count)`，由子类实现具体读取逻辑
 class ReaderStrategy {
 public:
   virtual ~ReaderStrategy() = default;
-  virtual bool read(AppState &state, std::string type) const = 0;
+  virtual bool read(AppState &state, std::string type, size_t count) const = 0;
 };
 
 // ========== TypedReader<T> ==========
-/// 根据 T 类型来读取一个值，并把读取信息写进 status_msg
+/// 根据 T 类型来读取一个值（count > 1 时一次读取整个数组），
+/// 并把读取信息写进 status_msg
 template <typename T> class TypedReader : public ReaderStrategy {
 public:
   explicit TypedReader(std::string typeName) : typeName_(std::move(typeName)) {}
 
-  bool read(AppState &state, std::string type) const override {
+  bool read(AppState &state, std::string type, size_t count) const override {
     const size_t orig_pos = state.cursor_pos;
+    if (count > 1) {
+      const std::vector<T> values = state.read_array<T>(orig_pos, count);
+      state.status_msg = fmt::format(
+          "Read {}[{}]: {} @ 0x{:X}", type, count, Utils::format_array(values),
+          static_cast<unsigned long long>(orig_pos));
+      return true;
+    }
     T value = state.read<T>(orig_pos);
     state.status_msg =
         fmt::format("Read {}: {} @ 0x{:X}", type, Utils::format_value(value),
@@ -401,14 +810,18 @@ private:
 /// 固定长度字符串读取，每次读取长度为 5
 class FixStringReader : public ReaderStrategy {
 public:
-  bool read(AppState &state, std::string type) const override {
+  /// count > 1 时依次读取 count 个字符串，每个各记一条
+  bool read(AppState &state, std::string type, size_t count) const override {
     try {
-      const size_t orig_pos = state.cursor_pos;
       size_t len = Utils::parse_char_length(type);
-      std::string value = state.read_fixed_string(orig_pos, len);
-      state.status_msg =
-          fmt::format("Read {}: {} @ 0x{:X}", type, Utils::format_value(value),
-                      static_cast<unsigned long long>(orig_pos));
+      for (size_t i = 0; i < count; ++i) {
+        const size_t orig_pos = state.cursor_pos;
+        const ByteSpan value = state.read_fixed_string(orig_pos, len);
+        state.status_msg = fmt::format(
+            "Read {}: {} @ 0x{:X}", type,
+            state.text(value, ReadHistory::kPreviewChars),
+            static_cast<unsigned long long>(orig_pos));
+      }
       return true;
     } catch (const std::exception &e) {
       state.status_msg = fmt::format("{} read failed: {}", type, e.what());
@@ -422,12 +835,17 @@ public:
 template <typename LengthType>
 class LengthPrefixedStringReader : public ReaderStrategy {
 public:
-  bool read(AppState &state, std::string type) const override {
-    const size_t orig_pos = state.cursor_pos;
-    std::string value = state.read_length_prefixed_string<LengthType>(orig_pos);
-    state.status_msg =
-        fmt::format("Read {}: {} @ 0x{:X}", type, Utils::format_value(value),
-                    static_cast<unsigned long long>(orig_pos));
+  /// count > 1 时依次读取 count 个字符串，每个各记一条
+  bool read(AppState &state, std::string type, size_t count) const override {
+    for (size_t i = 0; i < count; ++i) {
+      const size_t orig_pos = state.cursor_pos;
+      const ByteSpan value =
+          state.read_length_prefixed_string<LengthType>(orig_pos);
+      state.status_msg = fmt::format(
+          "Read {}: {} @ 0x{:X}", type,
+          state.text(value, ReadHistory::kPreviewChars),
+          static_cast<unsigned long long>(orig_pos));
+    }
     return true;
   }
 };
@@ -440,9 +858,9 @@ public:
   /// 拿到单例引用
   static const ReaderFactory &instance();
 
-  /// 通过 type 字符串去 readers_ map 中找，若存在则执行对应的 read() 并返回
-  /// true
-  bool read(AppState &state, const std::string &type) const;
+  /// 通过 type 字符串去 readers_ map 中找，若存在则执行对应的 read()
+  /// （读取 count 个）并返回 true
+  bool read(AppState &state, const std::string &type, size_t count = 1) const;
 
 private:
   ReaderFactory(); // 构造函数私有
@@ -0,0 +1,261 @@
+#include "BlockStats.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace {
+constexpr auto kNotifyInterval = std::chrono::milliseconds(100);
+constexpr uint32_t kUnreadableBit = 0x80; // level 字节的最高位
+
+uint32_t pack(const BlockSummary &s) {
+  auto quantize = [](double v) {
+    return static_cast<uint32_t>(std::lround(std::clamp(v, 0.0, 1.0) * 255));
+  };
+  return quantize(s.entropy / 8) << 24 | quantize(s.zero_ratio) << 16 |
+         quantize(s.printable_ratio) << 8 |
+         (s.unreadable ? kUnreadableBit : 0) |
+         static_cast<uint32_t>(s.level);
+}
+
+BlockSummary unpack(uint32_t v) {
+  BlockSummary s;
+  s.entropy = ((v >> 24) & 0xFF) / 255.0 * 8;
+  s.zero_ratio = ((v >> 16) & 0xFF) / 255.0;
+  s.printable_ratio = ((v >> 8) & 0xFF) / 255.0;
+  s.level = static_cast<int>(v & 0x7F);
+  s.unreadable = (v & kUnreadableBit) != 0;
+  return s;
+}
+
+bool printable(size_t byte) {
+  return (byte >= 0x20 && byte <= 0x7E) || byte == '\t' || byte == '\n' ||
+         byte == '\r';
+}
+} // namespace
+
+BlockStats::BlockStats(std::shared_ptr<const DataSource> source, size_t cells,
+                       std::function<void()> on_progress, size_t threads,
+                       const BlockStats *previous)
+    : source_(std::move(source)), on_progress_(std::move(on_progress)),
+      cells_(std::max<size_t>(1, cells)) {
+  size_ = source_ ? source_->size() : 0;
+  extents_ = source_ ? source_->extents() : nullptr;
+  if (previous)
+    seed(*previous);
+  if (threads == 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  // 块比线程少时不需要那么多线程
+  threads_ = std::min(threads, cells_.size());
+  for (size_t i = 0; i < threads_; ++i)
+    workers_.emplace_back(&BlockStats::run, this);
+}
+
+BlockStats::~BlockStats() {
+  stop_.store(true);
+  for (auto &worker : workers_)
+    worker.join();
+}
+
+size_t BlockStats::cell_offset(size_t index) const {
+  // 拆成商与余数两部分，避免 size_ * index 溢出
+  const size_t n = cells_.size();
+  return size_ / n * index + size_ % n * index / n;
+}
+
+size_t BlockStats::cell_at(size_t pos) const {
+  if (size_ == 0)
+    return 0;
+  // 在块起点上二分，找最后一个起点不超过 pos 的块
+  pos = std::min(pos, size_ - 1);
+  size_t lo = 0, hi = cells_.size() - 1;
+  while (lo < hi) {
+    const size_t mid = lo + (hi - lo + 1) / 2;
+    if (cell_offset(mid) <= pos)
+      lo = mid;
+    else
+      hi = mid - 1;
+  }
+  return lo;
+}
+
+BlockSummary BlockStats::cell(size_t index) const {
+  return unpack(cells_[index].load(std::memory_order_relaxed));
+}
+
+BlockSummary BlockStats::summary(size_t first, size_t last) const {
+  last = std::min(last, cells_.size());
+  BlockSummary total;
+  if (first >= last)
+    return total;
+  total.level = 2;
+  for (size_t i = first; i < last; ++i) {
+    const BlockSummary s = cell(i);
+    total.entropy += s.entropy;
+    total.zero_ratio += s.zero_ratio;
+    total.printable_ratio += s.printable_ratio;
+    total.level = std::min(total.level, s.level);
+    total.unreadable = total.unreadable || s.unreadable;
+  }
+  const auto n = static_cast<double>(last - first);
+  total.entropy /= n;
+  total.zero_ratio /= n;
+  total.printable_ratio /= n;
+  return total;
+}
+
+void BlockStats::wait() const {
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_cv_.wait(lock, [this] { return done() || stop_.load(); });
+}
+
+void BlockStats::run() {
+  // 先粗后细：第一遍让整张地图尽快出现，第二遍逐步替换为更准确的结果
+  for (int pass = 0; pass < 2 && !stop_.load(); ++pass) {
+    while (!stop_.load()) {
+      const size_t i = next_[pass]++;
+      if (i >= cells_.size())
+        break;
+      // 沿用的结果已经够细，出错的块不再重试
+      const BlockSummary current = cell(i);
+      if (current.level > pass || current.unreadable)
+        continue;
+      compute(i, pass + 1);
+      notify(false);
+    }
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    finished_.fetch_add(1, std::memory_order_acq_rel);
+  }
+  done_cv_.notify_all();
+  if (done())
+    notify(true);
+}
+
+void BlockStats::seed(const BlockStats &previous) {
+  // 数据只在末尾增长：旧范围内的字节没有变化
+  if (previous.size_ == 0 || previous.size_ > size_)
+    return;
+  for (size_t i = 0; i < cells_.size(); ++i) {
+    const size_t begin = cell_offset(i);
+    const size_t end = cell_offset(i + 1);
+    if (end > previous.size_)
+      break; // 之后的块都越过了旧末尾
+    if (begin == end)
+      continue;
+    BlockSummary s;
+    s.level = 2;
+    double weight = 0;
+    for (size_t k = previous.cell_at(begin); k <= previous.cell_at(end - 1);
+         ++k) {
+      const BlockSummary old = previous.cell(k);
+      if (old.level == 0 || old.unreadable) {
+        s.level = 0;
+        break;
+      }
+      const auto w = static_cast<double>(
+          std::min(end, previous.cell_offset(k + 1)) -
+          std::max(begin, previous.cell_offset(k)));
+      s.entropy += old.entropy * w;
+      s.zero_ratio += old.zero_ratio * w;
+      s.printable_ratio += old.printable_ratio * w;
+      s.level = std::min(s.level, old.level);
+      weight += w;
+    }
+    if (s.level == 0 || weight == 0)
+      continue;
+    s.entropy /= weight;
+    s.zero_ratio /= weight;
+    s.printable_ratio /= weight;
+    cells_[i].store(pack(s), std::memory_order_relaxed);
+  }
+}
+
+void BlockStats::compute(size_t index, int level) {
+  const size_t begin = cell_offset(index);
+  const size_t end = cell_offset(index + 1);
+  const size_t length = end - begin;
+  if (length == 0) {
+    cells_[index].store(pack(BlockSummary{0, 0, 0, level}));
+    return;
+  }
+
+  // 采样：块不大时整块读取，否则在块内均匀取若干个 kChunk
+  const size_t budget = level == 1 ? kCoarseSample : kFineSample;
+  const size_t chunks = length <= budget ? 1 : budget / kChunk;
+  const size_t chunk_len = length <= budget ? length : kChunk;
+
+  std::array<size_t, 256> histogram{};
+  std::vector<uint8_t> buf(std::min(chunk_len, kFineSample));
+  size_t counted = 0;
+  try {
+    for (size_t c = 0; c < chunks && !stop_.load(); ++c) {
+      const size_t at = chunks == 1 ? begin
+                                    : begin + (length - chunk_len) /
+                                                  (chunks - 1) * c;
+      // 不为统计去打开文件（拼接中尚未访问的文件段）
+      if (!source_->resident(at, chunk_len))
+        continue;
+      size_t done = 0;
+      while (done < chunk_len) {
+        const size_t pos = at + done;
+        // 空洞按全零计入，不读取
+        if (extents_) {
+          if (auto hole = extents_->hole_at(pos)) {
+            const size_t n = std::min(chunk_len - done, hole->end() - pos);
+            histogram[0] += n;
+            done += n;
+            continue;
+          }
+        }
+        const size_t n = std::min(chunk_len - done, buf.size());
+        const size_t got = source_->read(pos, buf.data(), n);
+        for (size_t k = 0; k < got; ++k)
+          ++histogram[buf[k]];
+        done += n;
+        if (got < n)
+          histogram[0] += n - got;
+      }
+      counted += chunk_len;
+    }
+  } catch (const std::exception &) {
+    // 读取出错（I/O 错误、拼接的文件段无法打开等）：只标记该块，
+    // 异常不能逃出工作线程
+    BlockSummary s;
+    s.level = level;
+    s.unreadable = true;
+    cells_[index].store(pack(s), std::memory_order_relaxed);
+    return;
+  }
+  if (counted == 0)
+    return;
+
+  BlockSummary s;
+  s.level = level;
+  size_t printable_count = 0;
+  for (size_t b = 0; b < 256; ++b) {
+    if (histogram[b] == 0)
+      continue;
+    const double p = static_cast<double>(histogram[b]) / counted;
+    s.entropy -= p * std::log2(p);
+    if (printable(b))
+      printable_count += histogram[b];
+  }
+  s.zero_ratio = static_cast<double>(histogram[0]) / counted;
+  s.printable_ratio = static_cast<double>(printable_count) / counted;
+  cells_[index].store(pack(s), std::memory_order_relaxed);
+}
+
+void BlockStats::notify(bool force) {
+  if (!on_progress_)
+    return;
+  const int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+                          std::chrono::steady_clock::now().time_since_epoch())
+                          .count();
+  int64_t last = last_notify_.load();
+  if (!force && now - last < kNotifyInterval.count())
+    return;
+  if (force || last_notify_.compare_exchange_strong(last, now))
+    on_progress_();
+}
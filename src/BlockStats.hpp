@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "DataSource.hpp"
+
+/// 一个块的统计摘要
+struct BlockSummary {
+  double entropy = 0;         // 字节熵（0~8 bit）
+  double zero_ratio = 0;      // 0x00 字节占比
+  double printable_ratio = 0; // 可打印 ASCII（含 \t \n \r）占比
+  int level = 0;              // 0 尚未计算，1 粗略采样，2 精细采样
+  bool unreadable = false;    // 读取出错
+};
+
+// ========== BlockStats ==========
+/// 把整个数据源均分为 cells 个块，由后台线程池计算每块的熵、零字节占比与
+/// 可打印字符占比（概览小地图使用）。先对每块做一次小采样得到粗略结果，
+/// 再用更多采样逐步细化；空洞部分按全零计入而不读取，尚未打开的部分
+/// （DataSource::resident）不采样，读取出错的块标记为 unreadable。
+/// 结果以打包的原子量保存，界面线程随时可以读取当前进度
+class BlockStats {
+public:
+  static constexpr size_t kCoarseSample = 4 * 1024;  // 第一遍每块采样字节数
+  static constexpr size_t kFineSample = 256 * 1024;  // 第二遍每块采样字节数
+  static constexpr size_t kChunk = 4 * 1024;         // 每次读取的字节数
+
+  /// 开始计算；threads 为 0 时按硬件并发数选择。on_progress 在工作线程中
+  /// 调用（有节流），全部完成时再调用一次。previous 为同一数据源在末尾
+  /// 增长之前的统计：完全落在旧范围内的块沿用其结果，只计算新增部分
+  BlockStats(std::shared_ptr<const DataSource> source, size_t cells,
+             std::function<void()> on_progress = {}, size_t threads = 0,
+             const BlockStats *previous = nullptr);
+  ~BlockStats();
+  BlockStats(const BlockStats &) = delete;
+  BlockStats &operator=(const BlockStats &) = delete;
+
+  [[nodiscard]] size_t cells() const { return cells_.size(); }
+  [[nodiscard]] size_t data_size() const { return size_; }
+  [[nodiscard]] const DataSource *source() const { return source_.get(); }
+
+  /// 第 index 块的起始偏移
+  [[nodiscard]] size_t cell_offset(size_t index) const;
+  /// pos 所在块的下标
+  [[nodiscard]] size_t cell_at(size_t pos) const;
+
+  /// 第 index 块的当前结果
+  [[nodiscard]] BlockSummary cell(size_t index) const;
+  /// [first, last) 块的平均值（level 取最小值）
+  [[nodiscard]] BlockSummary summary(size_t first, size_t last) const;
+
+  /// 两遍计算是否都已完成
+  [[nodiscard]] bool done() const {
+    return finished_.load(std::memory_order_acquire) == threads_;
+  }
+  /// 阻塞直到计算完成
+  void wait() const;
+
+private:
+  void run();
+  /// 用 previous 中覆盖同一范围的块（按重叠长度加权）初始化各块
+  void seed(const BlockStats &previous);
+  void compute(size_t index, int level);
+  void notify(bool force);
+
+  std::shared_ptr<const DataSource> source_;
+  std::shared_ptr<const ExtentMap> extents_;
+  size_t size_ = 0;
+  std::function<void()> on_progress_;
+
+  // 打包为 32 位：熵(8) | 零字节占比(8) | 可打印占比(8) | level(8)
+  std::vector<std::atomic<uint32_t>> cells_;
+
+  std::atomic<size_t> next_[2] = {{0}, {0}}; // 每一遍下一个待计算的块
+  std::atomic<bool> stop_{false};
+  size_t threads_ = 0;
+  std::atomic<size_t> finished_{0};
+  std::atomic<int64_t> last_notify_{0};
+  mutable std::mutex mutex_;
+  mutable std::condition_variable done_cv_;
+  std::vector<std::thread> workers_;
+};
@@ -0,0 +1,119 @@
+#include "ByteClass.hpp"
+
+#include <array>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define BIN_READER_X86_SIMD 1
+#endif
+
+namespace {
+constexpr uint8_t cls(ByteClass c) { return static_cast<uint8_t>(c); }
+
+constexpr auto kClassTable = [] {
+  std::array<uint8_t, 256> table{};
+  for (size_t i = 0; i < 256; ++i) {
+    ByteClass c = ByteClass::Control;
+    if (i == 0x00)
+      c = ByteClass::Zero;
+    else if (i == 0xFF)
+      c = ByteClass::Ones;
+    else if (i >= 0x80)
+      c = ByteClass::HighBit;
+    else if (i == 0x20 || (i >= 0x09 && i <= 0x0D))
+      c = ByteClass::Whitespace;
+    else if (i > 0x20 && i < 0x7F)
+      c = ByteClass::Printable;
+    table[i] = cls(c);
+  }
+  return table;
+}();
+
+#ifdef BIN_READER_X86_SIMD
+// 按有符号字节比较：0x80 以上都是负数，因此 ASCII 区间的比较自然排除高位字节。
+// 各掩码按优先级依次覆盖，结果等同于 kClassTable
+
+/// 16 字节一组，返回处理到的位置
+size_t classify_sse2(const uint8_t *src, uint8_t *dst, size_t n) {
+  const auto set = [](int v) { return _mm_set1_epi8(static_cast<char>(v)); };
+  const auto select = [](__m128i mask, __m128i value, __m128i r) {
+    return _mm_or_si128(_mm_and_si128(mask, value), _mm_andnot_si128(mask, r));
+  };
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+    const __m128i printable =
+        _mm_and_si128(_mm_cmpgt_epi8(x, set(0x20)), _mm_cmplt_epi8(x, set(0x7F)));
+    const __m128i space = _mm_or_si128(
+        _mm_cmpeq_epi8(x, set(0x20)),
+        _mm_and_si128(_mm_cmpgt_epi8(x, set(0x08)), _mm_cmplt_epi8(x, set(0x0E))));
+    const __m128i high = _mm_cmplt_epi8(x, _mm_setzero_si128());
+
+    __m128i r = set(cls(ByteClass::Control));
+    r = select(printable, set(cls(ByteClass::Printable)), r);
+    r = select(space, set(cls(ByteClass::Whitespace)), r);
+    r = select(high, set(cls(ByteClass::HighBit)), r);
+    r = select(_mm_cmpeq_epi8(x, set(0xFF)), set(cls(ByteClass::Ones)), r);
+    r = select(_mm_cmpeq_epi8(x, _mm_setzero_si128()), set(cls(ByteClass::Zero)), r);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), r);
+  }
+  return i;
+}
+
+/// 32 字节一组（只在 CPU 支持 AVX2 时调用）。lambda 不继承 target 属性，
+/// 这里直接展开
+__attribute__((target("avx2"))) size_t classify_avx2(const uint8_t *src,
+                                                      uint8_t *dst, size_t n) {
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i ones = _mm256_set1_epi8(static_cast<char>(0xFF));
+  const __m256i c08 = _mm256_set1_epi8(0x08);
+  const __m256i c0e = _mm256_set1_epi8(0x0E);
+  const __m256i c20 = _mm256_set1_epi8(0x20);
+  const __m256i c7f = _mm256_set1_epi8(0x7F);
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    const __m256i x =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+    const __m256i printable = _mm256_and_si256(_mm256_cmpgt_epi8(x, c20),
+                                               _mm256_cmpgt_epi8(c7f, x));
+    const __m256i space = _mm256_or_si256(
+        _mm256_cmpeq_epi8(x, c20), _mm256_and_si256(_mm256_cmpgt_epi8(x, c08),
+                                                    _mm256_cmpgt_epi8(c0e, x)));
+    const __m256i high = _mm256_cmpgt_epi8(zero, x);
+
+    __m256i r = _mm256_set1_epi8(cls(ByteClass::Control));
+    r = _mm256_blendv_epi8(r, _mm256_set1_epi8(cls(ByteClass::Printable)),
+                           printable);
+    r = _mm256_blendv_epi8(r, _mm256_set1_epi8(cls(ByteClass::Whitespace)),
+                           space);
+    r = _mm256_blendv_epi8(r, _mm256_set1_epi8(cls(ByteClass::HighBit)), high);
+    r = _mm256_blendv_epi8(r, _mm256_set1_epi8(cls(ByteClass::Ones)),
+                           _mm256_cmpeq_epi8(x, ones));
+    r = _mm256_blendv_epi8(r, _mm256_set1_epi8(cls(ByteClass::Zero)),
+                           _mm256_cmpeq_epi8(x, zero));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), r);
+  }
+  return i;
+}
+
+bool has_avx2() {
+  static const bool supported = __builtin_cpu_supports("avx2");
+  return supported;
+}
+#endif
+} // namespace
+
+void classify_bytes_scalar(const uint8_t *src, uint8_t *dst, size_t n) {
+  for (size_t i = 0; i < n; ++i)
+    dst[i] = kClassTable[src[i]];
+}
+
+void classify_bytes(const uint8_t *src, uint8_t *dst, size_t n) {
+  size_t done = 0;
+#ifdef BIN_READER_X86_SIMD
+  if (has_avx2())
+    done = classify_avx2(src, dst, n);
+  done += classify_sse2(src + done, dst + done, n - done);
+#endif
+  classify_bytes_scalar(src + done, dst + done, n - done);
+}
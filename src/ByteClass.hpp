@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// ========== ByteClass ==========
+/// Hex 视图按字节类别着色使用的分类
+enum class ByteClass : uint8_t {
+  Zero,       // 0x00
+  Printable,  // 0x21 ~ 0x7E
+  Whitespace, // 空格、\t \n \v \f \r
+  Control,    // 其余 0x01 ~ 0x1F 与 0x7F
+  HighBit,    // 0x80 ~ 0xFE
+  Ones,       // 0xFF
+};
+
+inline constexpr size_t kByteClassCount = 6;
+
+/// 把 src 中 n 个字节的类别（ByteClass 的数值）写入 dst。
+/// x86-64 上整段用 SIMD 比较与掩码合成，不逐字节分支
+/// （支持 AVX2 时每次 32 字节，否则 SSE2 每次 16 字节），剩余部分与
+/// 其他平台查表完成
+void classify_bytes(const uint8_t *src, uint8_t *dst, size_t n);
+
+/// 纯查表实现（供测试对照）
+void classify_bytes_scalar(const uint8_t *src, uint8_t *dst, size_t n);
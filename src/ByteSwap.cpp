@@ -0,0 +1,70 @@
+#include "ByteSwap.hpp"
+
+#include <algorithm>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define BIN_READER_X86_SIMD 1
+#endif
+
+namespace {
+#ifdef BIN_READER_X86_SIMD
+/// 16 字节内按 width 颠倒每个元素的重排表
+__attribute__((target("ssse3"))) __m128i shuffle_mask(size_t width) {
+  alignas(16) uint8_t mask[16];
+  for (size_t i = 0; i < 16; ++i)
+    mask[i] = static_cast<uint8_t>(i / width * width + (width - 1 - i % width));
+  return _mm_load_si128(reinterpret_cast<const __m128i *>(mask));
+}
+
+/// 32 字节一组，返回处理的字节数
+__attribute__((target("avx2"))) size_t swap_avx2(uint8_t *bytes, size_t n,
+                                                  size_t width) {
+  const __m128i half = shuffle_mask(width);
+  // vpshufb 在两个 128 位通道内各自重排，两半使用同一张表
+  const __m256i mask = _mm256_broadcastsi128_si256(half);
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    auto *p = reinterpret_cast<__m256i *>(bytes + i);
+    _mm256_storeu_si256(p, _mm256_shuffle_epi8(_mm256_loadu_si256(p), mask));
+  }
+  return i;
+}
+
+/// 16 字节一组，返回处理的字节数
+__attribute__((target("ssse3"))) size_t swap_ssse3(uint8_t *bytes, size_t n,
+                                                    size_t width) {
+  const __m128i mask = shuffle_mask(width);
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    auto *p = reinterpret_cast<__m128i *>(bytes + i);
+    _mm_storeu_si128(p, _mm_shuffle_epi8(_mm_loadu_si128(p), mask));
+  }
+  return i;
+}
+#endif
+} // namespace
+
+void byteswap_array_scalar(uint8_t *bytes, size_t width, size_t count) {
+  for (size_t i = 0; i < count; ++i)
+    std::reverse(bytes + i * width, bytes + (i + 1) * width);
+}
+
+void byteswap_array(uint8_t *bytes, size_t width, size_t count) {
+  if (width <= 1 || count == 0)
+    return;
+  const size_t n = width * count;
+  size_t done = 0;
+#ifdef BIN_READER_X86_SIMD
+  // 16 与 32 都是元素宽度的整数倍，分组边界不会切开元素
+  if (16 % width == 0) {
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    static const bool ssse3 = __builtin_cpu_supports("ssse3");
+    if (avx2)
+      done = swap_avx2(bytes, n, width);
+    if (ssse3)
+      done += swap_ssse3(bytes + done, n - done, width);
+  }
+#endif
+  byteswap_array_scalar(bytes + done, width, (n - done) / width);
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// ========== ByteSwap ==========
+/// 把 count 个连续的 width 字节元素（width 为 1/2/4/8）逐个颠倒字节序。
+/// x86-64 上用字节重排指令一次处理 32 字节（AVX2）或 16 字节（SSSE3），
+/// 运行时按 CPU 选择；剩余部分与其他平台逐元素交换
+void byteswap_array(uint8_t *bytes, size_t width, size_t count);
+
+/// 逐元素实现（供测试对照）
+void byteswap_array_scalar(uint8_t *bytes, size_t width, size_t count);
@@ -1,11 +1,75 @@
 #include "Command.hpp"
 #include "AppState.hpp"
+#include "FrameStats.hpp"
+#include <cctype>
 #include <fmt/format.h>
+#include <optional>
+
+namespace {
+/// 解析非负整数（"0x"/"0X" 前缀按十六进制）。std::stoull 会把 "-1" 回绕成
+/// 极大值，所以要求第一个字符就是数字
+size_t parse_unsigned(const std::string &text) {
+  const bool hex = text.size() > 1 && text[0] == '0' &&
+                   (text[1] == 'x' || text[1] == 'X');
+  const std::string digits = hex ? text.substr(2) : text;
+  if (digits.empty() || !std::isxdigit(static_cast<unsigned char>(digits[0])))
+    throw std::invalid_argument("expected a non-negative number");
+  size_t used = 0;
+  const size_t value = std::stoull(digits, &used, hex ? 16 : 10);
+  if (used != digits.size())
+    throw std::invalid_argument("trailing characters");
+  return value;
+}
+
+/// 解析 "<name> [count] [@addr]" 中的 count 与 @addr（不移动光标）；
+/// 出错时写入 status_msg 并返回 false
+bool parse_count_and_address(AppState &state, const ParsedCommand &cmd,
+                             const char *usage, size_t &count,
+                             std::optional<size_t> &at) {
+  try {
+    for (size_t i = 1; i < cmd.args.size(); ++i) {
+      const std::string &arg = cmd.args[i];
+      if (arg[0] == '@')
+        at = parse_unsigned(arg.substr(1));
+      else
+        count = parse_unsigned(arg);
+    }
+  } catch (...) {
+    state.status_msg = fmt::format("Usage: {} [count] [@addr]", usage);
+    return false;
+  }
+  if (count == 0) {
+    state.status_msg = "Count must be at least 1.";
+    return false;
+  }
+  if (at && *at >= state.data.size()) {
+    state.status_msg = fmt::format("Address 0x{:X} out of range.", *at);
+    return false;
+  }
+  return true;
+}
+} // namespace
 
 void register_all_commands() {
   CommandRegistry::instance().register_command(
       "u", [](AppState &state, const ParsedCommand &) { state.undo(); });
 
+  CommandRegistry::instance().register_command(
+      "redo", [](AppState &state, const ParsedCommand &) {
+        if (!state.redo())
+          state.status_msg = "Nothing to redo";
+      });
+
+  CommandRegistry::instance().register_command(
+      "branch", [](AppState &state, const ParsedCommand &) {
+        const size_t count = state.read_history.switch_branch();
+        if (count < 2)
+          state.status_msg = "No other branch to redo";
+        else
+          state.status_msg =
+              fmt::format("Redo switched to another of {} branches", count);
+      });
+
   CommandRegistry::instance().register_command(
       "be", [](AppState &state, const ParsedCommand &) {
         state.is_little_endian = false;
@@ -47,13 +111,226 @@ void register_all_commands() {
         }
       });
 
+  CommandRegistry::instance().register_command(
+      "nd", [](AppState &state, const ParsedCommand &) {
+        if (state.next_data())
+          state.status_msg =
+              fmt::format("Next data at 0x{:X}", state.cursor_pos);
+        else
+          state.status_msg = "No more data extents.";
+      });
+
+  CommandRegistry::instance().register_command(
+      "pd", [](AppState &state, const ParsedCommand &) {
+        if (state.prev_data())
+          state.status_msg =
+              fmt::format("Previous data at 0x{:X}", state.cursor_pos);
+        else
+          state.status_msg = "No previous data extent.";
+      });
+
   CommandRegistry::instance().register_command(
       "r", [](AppState &state, const ParsedCommand &cmd) {
+        // r <type> [count] [@addr]
+        size_t count = 1;
+        std::optional<size_t> at;
+        if (!parse_count_and_address(state, cmd, "r <type>", count, at))
+          return;
+        // 读取器从光标处读取：先移到 addr，没有读到任何记录时再移回，
+        // 失败的读取不会留下一个无法 undo 的光标跳转
+        const size_t orig_pos = state.cursor_pos;
+        const size_t recorded = state.read_history.size();
+        if (at)
+          state.set_cursor_pos(*at);
         try {
-          ReaderFactory::instance().read(state, cmd.arg(0));
+          ReaderFactory::instance().read(state, cmd.arg(0), count);
+        } catch (const DataPendingError &) {
+          state.status_msg = "Data still loading, try again.";
         } catch (...) {
           state.status_msg = "Read failed.";
         }
+        if (state.read_history.size() == recorded)
+          state.set_cursor_pos(orig_pos);
+      });
+
+  CommandRegistry::instance().register_command(
+      "schema", [](AppState &state, const ParsedCommand &cmd) {
+        if (cmd.args.empty()) {
+          std::string names;
+          for (const auto &[name, plan] : state.schemas)
+            names += (names.empty() ? "" : " ") + name;
+          state.status_msg = names.empty() ? "Usage: schema <file>"
+                                           : "Structs: " + names;
+          return;
+        }
+        try {
+          const size_t n = state.load_schema(cmd.arg(0));
+          state.status_msg =
+              fmt::format("Loaded {} struct(s) from {}", n, cmd.arg(0));
+        } catch (const std::exception &e) {
+          state.status_msg = fmt::format("Schema error: {}", e.what());
+        }
+      });
+
+  CommandRegistry::instance().register_command(
+      "apply", [](AppState &state, const ParsedCommand &cmd) {
+        // apply <struct> [count] [@addr]
+        size_t count = 1;
+        std::optional<size_t> at;
+        if (cmd.args.empty()) {
+          state.status_msg = "Usage: apply <struct> [count] [@addr]";
+          return;
+        }
+        if (!parse_count_and_address(state, cmd, "apply <struct>", count, at))
+          return;
+        // 检查通过后 apply 才移动光标
+        const size_t pos = at.value_or(state.cursor_pos);
+        try {
+          const size_t n = state.apply_struct(cmd.arg(0), pos, count);
+          state.status_msg = fmt::format(
+              "Applied {} x{} ({} bytes) @ 0x{:X}", cmd.arg(0), count, n,
+              static_cast<unsigned long long>(pos));
+        } catch (const DataPendingError &) {
+          state.status_msg = "Data still loading, try again.";
+        } catch (const std::invalid_argument &e) {
+          state.status_msg = e.what();
+        } catch (const std::out_of_range &) {
+          state.status_msg = "Struct runs past end of data.";
+        } catch (...) {
+          state.status_msg = "Apply failed.";
+        }
+      });
+
+  CommandRegistry::instance().register_command(
+      "follow", [](AppState &state, const ParsedCommand &cmd) {
+        const std::string mode = cmd.arg(0);
+        if (mode == "off") {
+          state.stop_follow();
+          state.status_msg = "Follow mode off";
+        } else if (mode.empty() || mode == "tail") {
+          if (state.start_follow(mode == "tail"))
+            state.status_msg = fmt::format("Following {}{}", state.file_name,
+                                           state.follow_tail ? " (tail)" : "");
+          else
+            state.status_msg = "Nothing to follow.";
+        } else {
+          state.status_msg = "Usage: follow [tail|off]";
+        }
+      });
+
+  CommandRegistry::instance().register_command(
+      "scroll", [](AppState &state, const ParsedCommand &cmd) {
+        const std::string mode = cmd.arg(0);
+        if (mode == "smooth" || (mode.empty() && !state.smooth_scroll)) {
+          state.set_smooth_scroll(true);
+          state.status_msg = "Smooth scrolling";
+        } else if (mode == "page" || mode.empty()) {
+          state.set_smooth_scroll(false);
+          state.status_msg = "Page scrolling";
+        } else {
+          state.status_msg = "Usage: scroll [smooth|page]";
+        }
+      });
+
+  CommandRegistry::instance().register_command(
+      "fit", [](AppState &state, const ParsedCommand &cmd) {
+        const std::string mode = cmd.arg(0);
+        if (mode.empty() || mode == "pow2") {
+          state.auto_fit = true;
+          state.fit_pow2 = true;
+        } else if (mode == "any") {
+          state.auto_fit = true;
+          state.fit_pow2 = false;
+        } else if (mode == "off") {
+          state.auto_fit = false;
+        } else {
+          state.status_msg = "Usage: fit [pow2|any|off]";
+          return;
+        }
+        state.status_msg =
+            state.auto_fit
+                ? fmt::format("Auto-fit on ({})",
+                              state.fit_pow2 ? "power-of-two" : "any width")
+                : "Auto-fit off";
+      });
+
+  CommandRegistry::instance().register_command(
+      "minimap", [](AppState &state, const ParsedCommand &cmd) {
+        const std::string mode = cmd.arg(0);
+        if (mode == "on" || (mode.empty() && !state.show_minimap)) {
+          state.show_minimap = true;
+        } else if (mode == "off" || mode.empty()) {
+          state.show_minimap = false;
+        } else {
+          state.status_msg = "Usage: minimap [on|off]";
+          return;
+        }
+        state.status_msg = state.show_minimap ? "Minimap on" : "Minimap off";
+      });
+
+  CommandRegistry::instance().register_command(
+      "color", [](AppState &state, const ParsedCommand &cmd) {
+        const std::string mode = cmd.arg(0);
+        if (mode == "on" || (mode.empty() && !state.byte_colors)) {
+          state.byte_colors = true;
+        } else if (mode == "off" || mode.empty()) {
+          state.byte_colors = false;
+        } else {
+          state.status_msg = "Usage: color [on|off]";
+          return;
+        }
+        state.status_msg =
+            state.byte_colors ? "Byte colouring on" : "Byte colouring off";
+      });
+
+  CommandRegistry::instance().register_command(
+      "perf", [](AppState &state, const ParsedCommand &cmd) {
+        FrameStats &perf = FrameStats::instance();
+        const std::string mode = cmd.arg(0);
+        if (mode == "dump") {
+          const std::string path = cmd.arg(1, "bin-reader-perf.csv");
+          state.status_msg =
+              perf.dump(path)
+                  ? fmt::format("Saved {} frames to {}", perf.frames(), path)
+                  : fmt::format("Cannot write {}", path);
+          return;
+        }
+        if (mode == "on" || (mode.empty() && !perf.enabled())) {
+          perf.set_enabled(true);
+        } else if (mode == "off" || mode.empty()) {
+          perf.set_enabled(false);
+        } else {
+          state.status_msg = "Usage: perf [on|off|dump [file]]";
+          return;
+        }
+        state.status_msg = perf.enabled() ? "Render stats on" : "Render stats off";
+      });
+
+  CommandRegistry::instance().register_command(
+      "hist", [](AppState &state, const ParsedCommand &cmd) {
+        const std::string dir = cmd.arg(0);
+        try {
+          // 超过记录数的滚动量与滚到头等价，先截断再转为有符号数
+          const auto n = static_cast<long>(std::min(
+              parse_unsigned(cmd.arg(1, "10")), state.read_history.size()));
+          if (dir == "up")
+            state.scroll_history(n);
+          else if (dir == "down")
+            state.scroll_history(-n);
+          else if (dir == "top")
+            state.history_scroll = state.read_history.size();
+          else if (dir == "end")
+            state.history_scroll = 0;
+          else {
+            state.status_msg = "Usage: hist up|down [n] | top | end";
+            return;
+          }
+          state.status_msg = fmt::format("History: {} records, {} above end",
+                                         state.read_history.size(),
+                                         state.history_scroll);
+        } catch (...) {
+          state.status_msg = "Invalid history offset.";
+        }
       });
 
   CommandRegistry::instance().register_command(
@@ -0,0 +1,121 @@
+#include "ConcatSource.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <utility>
+
+std::unique_ptr<ConcatSource>
+ConcatSource::open(const std::vector<std::string> &paths,
+                   const OpenOptions &options) {
+  std::unique_ptr<ConcatSource> source(new ConcatSource());
+  // 段长度取打开时的文件大小，因此各段按原始字节拼接（不解压 .gz）
+  source->options_ = options;
+  source->options_.gunzip = false;
+  source->options_.preload = false;
+
+  for (const auto &path : paths) {
+    std::error_code ec;
+    const auto length = std::filesystem::file_size(path, ec);
+    if (ec)
+      return nullptr;
+    source->segments_.push_back(
+        Segment{source->size_, static_cast<size_t>(length),
+                std::filesystem::path(path).filename().string()});
+    source->size_ += static_cast<size_t>(length);
+  }
+  source->paths_ = paths;
+  source->parts_.resize(paths.size());
+  return source;
+}
+
+size_t ConcatSource::opened_segments() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return static_cast<size_t>(
+      std::count_if(parts_.begin(), parts_.end(),
+                    [](const auto &part) { return part != nullptr; }));
+}
+
+bool ConcatSource::resident(size_t pos, size_t n) const {
+  if (pos >= size_ || n == 0)
+    return true;
+  const size_t last = segment_index(pos + std::min(n, size_ - pos) - 1);
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (size_t index = segment_index(pos); index <= last; ++index)
+    if (!parts_[index])
+      return false;
+  return true;
+}
+
+std::shared_ptr<DataSource> ConcatSource::part(size_t index) const {
+  std::shared_ptr<DataSource> failed;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (parts_[index])
+      return parts_[index];
+    try {
+      parts_[index] = open_data_source(paths_[index], options_);
+      return parts_[index];
+    } catch (const std::exception &e) {
+      // 空的数据源读不到任何字节，read 会用 0 补齐整段
+      failed = parts_[index] = std::make_shared<MemorySource>();
+      error_ =
+          fmt::format("Cannot open {}: {}", segments_[index].name, e.what());
+    }
+  }
+  // 触发重绘，让状态栏显示错误
+  if (options_.on_progress)
+    options_.on_progress();
+  return failed;
+}
+
+std::string ConcatSource::take_error() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return std::exchange(error_, {});
+}
+
+size_t ConcatSource::segment_index(size_t pos) const {
+  // 第一个起点大于 pos 的段的前一段即 pos 所在的段
+  auto it = std::upper_bound(
+      segments_.begin(), segments_.end(), pos,
+      [](size_t p, const Segment &seg) { return p < seg.offset; });
+  return static_cast<size_t>(std::prev(it) - segments_.begin());
+}
+
+void ConcatSource::advise(size_t pos, size_t n) const {
+  if (pos >= size_)
+    return;
+  const size_t end = pos + std::min(n, size_ - pos);
+  for (size_t index = segment_index(pos);
+       index < segments_.size() && segments_[index].offset < end; ++index) {
+    const Segment &seg = segments_[index];
+    const size_t from = std::max(pos, seg.offset) - seg.offset;
+    const size_t to = std::min(end, seg.offset + seg.length) - seg.offset;
+    if (from < to)
+      part(index)->advise(from, to - from);
+  }
+}
+
+size_t ConcatSource::read(size_t pos, uint8_t *dst, size_t n) const {
+  if (pos >= size_)
+    return 0;
+  n = std::min(n, size_ - pos);
+
+  size_t index = segment_index(pos);
+  size_t done = 0;
+  while (done < n && index < segments_.size()) {
+    const Segment &seg = segments_[index];
+    const size_t in_seg = pos + done - seg.offset;
+    if (in_seg < seg.length) {
+      const size_t want = std::min(n - done, seg.length - in_seg);
+      const size_t got = part(index)->read(in_seg, dst + done, want);
+      // 文件在打开后被截断：用 0 补齐，保持地址空间不变
+      std::memset(dst + done + got, 0, want - got);
+      done += want;
+    }
+    ++index;
+  }
+  return done;
+}
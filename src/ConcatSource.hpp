@@ -0,0 +1,54 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "DataSource.hpp"
+
+// ========== ConcatSource ==========
+/// 把多个文件（如轮转的 feed.0001.bin、feed.0002.bin ...）拼接成一个连续的
+/// 虚拟地址空间：打开时只读取各文件大小，每个文件段在第一次被访问时才打开
+/// （mmap 等），读取可以跨越文件接缝。文件段打不开（启动后被删除、改名或
+/// 失去权限）时该段按 0 读出，错误通过 take_error 报告
+class ConcatSource : public DataSource {
+public:
+  /// 按给定顺序拼接 paths；任一文件无法获取大小时返回 nullptr
+  static std::unique_ptr<ConcatSource>
+  open(const std::vector<std::string> &paths, const OpenOptions &options);
+
+  [[nodiscard]] size_t size() const override { return size_; }
+  size_t read(size_t pos, uint8_t *dst, size_t n) const override;
+  /// 把预读提示转发给覆盖到的各文件段
+  void advise(size_t pos, size_t n) const override;
+  /// 覆盖到的文件段是否都已打开
+  [[nodiscard]] bool resident(size_t pos, size_t n) const override;
+  [[nodiscard]] const std::vector<Segment> *segments() const override {
+    return &segments_;
+  }
+
+  std::string take_error() override;
+
+  /// 已经打开的文件段数量（包括打开失败、按 0 读出的段）
+  [[nodiscard]] size_t opened_segments() const;
+
+private:
+  ConcatSource() = default;
+
+  /// pos 所在文件段的下标（pos < size_）
+  size_t segment_index(size_t pos) const;
+
+  /// 取得第 index 段的数据源（必要时打开）；打不开时记下错误并换成
+  /// 空的数据源，不抛异常（读取在渲染中进行，没有地方接住异常）
+  std::shared_ptr<DataSource> part(size_t index) const;
+
+  std::vector<Segment> segments_;
+  std::vector<std::string> paths_;
+  OpenOptions options_;
+  size_t size_ = 0;
+
+  mutable std::mutex mutex_;
+  mutable std::vector<std::shared_ptr<DataSource>> parts_;
+  mutable std::string error_; // 尚未取走的打开错误
+};
@@ -0,0 +1,65 @@
+#include "DataPreview.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "FrameStats.hpp"
+#include "Utils.hpp"
+
+namespace {
+/// 从 bytes 的前 sizeof(T) 个字节按指定字节序解码出 T
+template <typename T> T decode(const uint8_t *bytes, bool little_endian) {
+  uint8_t raw[sizeof(T)];
+  std::memcpy(raw, bytes, sizeof(T));
+  if (!little_endian)
+    std::reverse(raw, raw + sizeof(T));
+  T value;
+  std::memcpy(&value, raw, sizeof(T));
+  return value;
+}
+
+template <typename T>
+std::string format_field(const uint8_t *bytes, bool little_endian) {
+  return Utils::format_value(decode<T>(bytes, little_endian));
+}
+
+/// 与 DataPreview::kFields 顺序一致的格式化函数表
+using Formatter = std::string (*)(const uint8_t *, bool);
+constexpr std::array<Formatter, DataPreview::kTypes> kFormatters = {
+    format_field<uint8_t>, format_field<uint16_t>, format_field<uint32_t>,
+    format_field<uint64_t>, format_field<int8_t>,  format_field<int16_t>,
+    format_field<int32_t>,  format_field<int64_t>, format_field<float>,
+    format_field<double>,
+};
+} // namespace
+
+bool DataPreview::update(const DataBuffer &data, size_t pos,
+                         bool little_endian) {
+  const size_t size = data.size();
+  if (valid_ && !data.live() && pos == pos_ &&
+      little_endian == little_endian_ && data.generation() == generation_ &&
+      size == data_size_)
+    return false;
+
+  valid_ = true;
+  pos_ = pos;
+  little_endian_ = little_endian;
+  generation_ = data.generation();
+  data_size_ = size;
+  ++computed_;
+
+  uint8_t bytes[8] = {};
+  size_t avail = 0;
+  {
+    FrameStats::Scope timing(FrameSection::Data);
+    avail = data.read(pos, bytes, sizeof(bytes));
+  }
+  const bool loading = data.loading();
+  for (size_t i = 0; i < kTypes; ++i) {
+    if (kFields[i].size <= avail)
+      values_[i] = kFormatters[i](bytes, little_endian);
+    else
+      values_[i] = loading ? "loading..." : "N/A";
+  }
+  return true;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+#include "DataSource.hpp"
+
+// ========== DataPreview ==========
+/// DataPreviewBar 的计算结果：光标处的十种数值解释。只有输入
+/// (pos, 字节序, 数据版本/大小) 变化时才重新计算；计算时一次读取 8 个字节，
+/// 所有类型都从这一份字节解码，区间在数据范围内时不经过异常
+class DataPreview {
+public:
+  static constexpr size_t kTypes = 10;
+
+  /// 一种解释：类型短名与字节数（显示顺序）
+  struct Field {
+    const char *label;
+    size_t size;
+  };
+  static constexpr std::array<Field, kTypes> kFields = {{
+      {"u8", 1},
+      {"u16", 2},
+      {"u32", 4},
+      {"u64", 8},
+      {"i8", 1},
+      {"i16", 2},
+      {"i32", 4},
+      {"i64", 8},
+      {"f32", 4},
+      {"f64", 8},
+  }};
+
+  /// 输入变化时重新解码；返回是否重新计算
+  bool update(const DataBuffer &data, size_t pos, bool little_endian);
+
+  /// 与 kFields 一一对应的显示文本（越界为 "N/A"，尚在加载为 "loading..."）
+  [[nodiscard]] const std::array<std::string, kTypes> &values() const {
+    return values_;
+  }
+
+  [[nodiscard]] bool little_endian() const { return little_endian_; }
+
+  /// 累计重新计算的次数
+  [[nodiscard]] size_t computed() const { return computed_; }
+
+private:
+  bool valid_ = false;
+  size_t pos_ = 0;
+  bool little_endian_ = true;
+  uint64_t generation_ = 0;
+  size_t data_size_ = 0;
+  size_t computed_ = 0;
+  std::array<std::string, kTypes> values_;
+};
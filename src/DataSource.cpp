@@ -0,0 +1,512 @@
+#include "DataSource.hpp"
+#include "ProcMemSource.hpp"
+#include "StreamSource.hpp"
+#include "Utils.hpp"
+#ifdef BIN_READER_WITH_ZLIB
+#include "GzipSource.hpp"
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define BIN_READER_POSIX_IO 1
+#endif
+
+// —— ExtentMap —— //
+std::optional<Extent> ExtentMap::hole_at(size_t pos) const {
+  if (pos >= size_)
+    return std::nullopt;
+  // 第一个起点大于 pos 的区段
+  auto it = std::upper_bound(
+      data_.begin(), data_.end(), pos,
+      [](size_t p, const Extent &e) { return p < e.offset; });
+  const size_t hole_begin = it == data_.begin() ? 0 : std::prev(it)->end();
+  if (pos < hole_begin)
+    return std::nullopt; // pos 落在前一个数据区段内
+  const size_t hole_end = it == data_.end() ? size_ : it->offset;
+  return Extent{hole_begin, hole_end - hole_begin};
+}
+
+std::optional<size_t> ExtentMap::next_data(size_t pos) const {
+  auto it = std::upper_bound(
+      data_.begin(), data_.end(), pos,
+      [](size_t p, const Extent &e) { return p < e.offset; });
+  if (it == data_.end())
+    return std::nullopt;
+  return it->offset;
+}
+
+std::optional<size_t> ExtentMap::prev_data(size_t pos) const {
+  auto it = std::upper_bound(
+      data_.begin(), data_.end(), pos,
+      [](size_t p, const Extent &e) { return p < e.offset; });
+  if (it == data_.begin())
+    return std::nullopt;
+  auto current = std::prev(it); // 起点 <= pos 的最后一个区段
+  if (pos < current->end()) {
+    // pos 在该区段内部：回到前一个区段
+    if (current == data_.begin())
+      return std::nullopt;
+    return std::prev(current)->offset;
+  }
+  return current->offset;
+}
+
+std::shared_ptr<const ExtentMap> scan_extents(int fd, size_t size) {
+#if defined(BIN_READER_POSIX_IO) && defined(SEEK_DATA) && defined(SEEK_HOLE)
+  std::vector<Extent> data;
+  off_t pos = 0;
+  while (static_cast<size_t>(pos) < size) {
+    const off_t begin = ::lseek(fd, pos, SEEK_DATA);
+    if (begin < 0) {
+      if (errno == ENXIO)
+        break; // 之后全是空洞
+      return nullptr; // 不支持 SEEK_DATA
+    }
+    off_t end = ::lseek(fd, begin, SEEK_HOLE);
+    if (end < 0 || static_cast<size_t>(end) > size)
+      end = static_cast<off_t>(size);
+    data.push_back(Extent{static_cast<size_t>(begin),
+                          static_cast<size_t>(end - begin)});
+    pos = end;
+  }
+  if (data.size() == 1 && data[0].offset == 0 && data[0].length == size)
+    return nullptr;
+  return std::make_shared<const ExtentMap>(std::move(data), size);
+#else
+  (void)fd;
+  (void)size;
+  return nullptr;
+#endif
+}
+
+// —— MemorySource —— //
+size_t MemorySource::read(size_t pos, uint8_t *dst, size_t n) const {
+  if (pos >= bytes_.size())
+    return 0;
+  n = std::min(n, bytes_.size() - pos);
+  std::memcpy(dst, bytes_.data() + pos, n);
+  return n;
+}
+
+// —— MmapSource —— //
+std::unique_ptr<MmapSource> MmapSource::open(const std::string &path) {
+#ifdef BIN_READER_POSIX_IO
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return nullptr;
+
+  struct stat st {};
+  if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+    ::close(fd);
+    return nullptr;
+  }
+
+  std::unique_ptr<MmapSource> source(new MmapSource(fd));
+  if (st.st_size > 0 && !source->map(static_cast<size_t>(st.st_size)))
+    return nullptr;
+  source->extents_ = scan_extents(fd, source->size());
+  return source;
+#else
+  (void)path;
+  return nullptr;
+#endif
+}
+
+bool MmapSource::map(size_t size) {
+#ifdef BIN_READER_POSIX_IO
+  // 超出文件末尾的部分在文件增长后即可访问，预留余量使持续追加的文件
+  // 很少需要重新映射；地址空间不足时退回到恰好的大小
+  const size_t reserve =
+      size + std::min(SIZE_MAX - size, std::max(size / 2, kMinReserve));
+  size_t length = reserve;
+  void *addr = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd_, 0);
+  if (addr == MAP_FAILED) {
+    length = size;
+    addr = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd_, 0);
+  }
+  if (addr == MAP_FAILED)
+    return false;
+  if (current_.addr)
+    retired_.push_back(current_);
+  current_ = Mapping{addr, length, length};
+  base_.store(static_cast<const uint8_t *>(addr), std::memory_order_release);
+  size_.store(size, std::memory_order_release);
+  return true;
+#else
+  (void)size;
+  return false;
+#endif
+}
+
+void MmapSource::cover_past(Mapping &m, size_t size) {
+#ifdef BIN_READER_POSIX_IO
+  // 最后一页中超出文件末尾的部分内核本就读作 0，只需替换其后的整页；
+  // MAP_FIXED 原地替换，地址不变
+  const auto page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+  const size_t keep = (size + page - 1) / page * page;
+  if (!m.addr || keep >= m.backed)
+    return;
+  void *tail = static_cast<uint8_t *>(m.addr) + keep;
+  if (::mmap(tail, m.backed - keep, PROT_READ,
+             MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0) != MAP_FAILED)
+    m.backed = keep;
+#else
+  (void)m;
+  (void)size;
+#endif
+}
+
+size_t MmapSource::refresh() {
+#ifdef BIN_READER_POSIX_IO
+  struct stat st {};
+  if (::fstat(fd_, &st) == 0) {
+    const auto now = static_cast<size_t>(std::max<off_t>(0, st.st_size));
+    const size_t before = size();
+    if (now > before && now <= current_.backed) {
+      // 仍在预留的余量内：已有映射直接覆盖新增部分
+      size_.store(now, std::memory_order_release);
+    } else if (now > before) {
+      if (!map(now))
+        throw std::runtime_error(fmt::format("Cannot map {} bytes: {}", now,
+                                             std::strerror(errno)));
+    } else if (now < before) {
+      // 文件被截断：先缩小可访问范围，再把截断部分换成零页。之后在零页
+      // 范围内的增长要重新映射（backed 已缩短）
+      size_.store(now, std::memory_order_release);
+      cover_past(current_, now);
+      for (Mapping &m : retired_)
+        cover_past(m, now);
+    }
+    if (size() != before)
+      std::atomic_store(&extents_, scan_extents(fd_, size()));
+  }
+#endif
+  return size();
+}
+
+MmapSource::~MmapSource() {
+#ifdef BIN_READER_POSIX_IO
+  if (current_.addr)
+    ::munmap(current_.addr, current_.length);
+  for (const Mapping &m : retired_)
+    ::munmap(m.addr, m.length);
+  if (fd_ >= 0)
+    ::close(fd_);
+#endif
+}
+
+size_t MmapSource::read(size_t pos, uint8_t *dst, size_t n) const {
+  const size_t total = size();
+  if (pos >= total)
+    return 0;
+  n = std::min(n, total - pos);
+  std::memcpy(dst, contiguous() + pos, n);
+  return n;
+}
+
+void MmapSource::advise(size_t pos, size_t n) const {
+#ifdef BIN_READER_POSIX_IO
+  const size_t total = size();
+  const uint8_t *base = contiguous();
+  if (!base || pos >= total || n == 0)
+    return;
+  n = std::min(n, total - pos);
+  // madvise 要求起始地址按页对齐（映射本身从页边界开始）
+  const auto page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+  const size_t start = pos / page * page;
+  ::madvise(const_cast<uint8_t *>(base) + start, pos + n - start,
+            MADV_WILLNEED);
+#else
+  (void)pos;
+  (void)n;
+#endif
+}
+
+// —— BlockCacheSource —— //
+std::unique_ptr<BlockCacheSource>
+BlockCacheSource::open(const std::string &path, size_t capacity_bytes,
+                       size_t block_size) {
+#ifdef BIN_READER_POSIX_IO
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return nullptr;
+
+  // 普通文件用 fstat（允许为空，之后可由 refresh 扩展），
+  // 块设备等用 lseek 到末尾获取大小
+  struct stat st {};
+  off_t end = -1;
+  if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode))
+    end = st.st_size;
+  else if ((end = ::lseek(fd, 0, SEEK_END)) == 0)
+    end = -1;
+  if (end < 0) {
+    ::close(fd);
+    return nullptr;
+  }
+
+  block_size = std::max<size_t>(1, block_size);
+  const size_t max_blocks = std::max<size_t>(1, capacity_bytes / block_size);
+  std::unique_ptr<BlockCacheSource> source(new BlockCacheSource(
+      fd, static_cast<size_t>(end), block_size, max_blocks));
+  source->extents_ = scan_extents(fd, source->size());
+  return source;
+#else
+  (void)path;
+  (void)capacity_bytes;
+  (void)block_size;
+  return nullptr;
+#endif
+}
+
+BlockCacheSource::~BlockCacheSource() {
+#ifdef BIN_READER_POSIX_IO
+  if (fd_ >= 0)
+    ::close(fd_);
+#endif
+}
+
+size_t BlockCacheSource::refresh() {
+#ifdef BIN_READER_POSIX_IO
+  struct stat st {};
+  if (::fstat(fd_, &st) == 0 && S_ISREG(st.st_mode)) {
+    const auto now = static_cast<size_t>(std::max<off_t>(0, st.st_size));
+    std::lock_guard<std::mutex> lock(mutex_);
+    // 末尾块可能只读到了一部分，大小变化后需要丢弃重读
+    const size_t before = size_.load();
+    if (now != before && before > 0) {
+      auto it = index_.find((before - 1) / block_size_);
+      if (it != index_.end()) {
+        lru_.erase(it->second);
+        index_.erase(it);
+      }
+    }
+    size_.store(now, std::memory_order_release);
+    std::atomic_store(&extents_, scan_extents(fd_, now));
+  }
+#endif
+  return size();
+}
+
+void BlockCacheSource::advise(size_t pos, size_t n) const {
+#if defined(BIN_READER_POSIX_IO) && defined(POSIX_FADV_WILLNEED)
+  const size_t total = size();
+  if (pos >= total || n == 0)
+    return;
+  n = std::min(n, total - pos);
+  ::posix_fadvise(fd_, static_cast<off_t>(pos), static_cast<off_t>(n),
+                  POSIX_FADV_WILLNEED);
+#else
+  (void)pos;
+  (void)n;
+#endif
+}
+
+size_t BlockCacheSource::cached_blocks() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return lru_.size();
+}
+
+const BlockCacheSource::Block &BlockCacheSource::fetch(size_t index) const {
+  auto it = index_.find(index);
+  if (it != index_.end()) {
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return lru_.front();
+  }
+
+  // 缓存已满时复用最久未用块的缓冲区，避免反复分配
+  if (lru_.size() >= max_blocks_) {
+    index_.erase(lru_.back().index);
+    lru_.splice(lru_.begin(), lru_, std::prev(lru_.end()));
+  } else {
+    lru_.emplace_front();
+  }
+  Block &block = lru_.front();
+  block.index = index;
+
+  const size_t offset = index * block_size_;
+  const size_t length = std::min(block_size_, size() - offset);
+  block.bytes.resize(length);
+#ifdef BIN_READER_POSIX_IO
+  size_t done = 0;
+  while (done < length) {
+    ssize_t got = ::pread(fd_, block.bytes.data() + done, length - done,
+                          static_cast<off_t>(offset + done));
+    if (got < 0 && errno == EINTR)
+      continue;
+    if (got <= 0)
+      break;
+    done += static_cast<size_t>(got);
+  }
+  if (done < length) {
+    lru_.pop_front();
+    throw std::runtime_error("Data source read error");
+  }
+#endif
+  index_[index] = lru_.begin();
+  return block;
+}
+
+size_t BlockCacheSource::read(size_t pos, uint8_t *dst, size_t n) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const size_t total = size();
+  if (pos >= total)
+    return 0;
+  n = std::min(n, total - pos);
+
+  const auto holes = extents();
+  size_t done = 0;
+  while (done < n) {
+    const size_t at = pos + done;
+    // 空洞直接补零，不读盘也不占用缓存
+    if (holes) {
+      if (auto hole = holes->hole_at(at)) {
+        const size_t chunk = std::min(n - done, hole->end() - at);
+        std::memset(dst + done, 0, chunk);
+        done += chunk;
+        continue;
+      }
+    }
+    const Block &block = fetch(at / block_size_);
+    const size_t in_block = at % block_size_;
+    const size_t chunk = std::min(n - done, block.bytes.size() - in_block);
+    std::memcpy(dst + done, block.bytes.data() + in_block, chunk);
+    done += chunk;
+  }
+  return n;
+}
+
+// —— AsyncLoadSource —— //
+std::unique_ptr<AsyncLoadSource>
+AsyncLoadSource::open(const std::string &path,
+                      std::function<void()> on_progress) {
+  std::error_code ec;
+  const auto total = std::filesystem::file_size(path, ec);
+  if (ec)
+    return nullptr;
+
+  std::unique_ptr<AsyncLoadSource> source(
+      new AsyncLoadSource(static_cast<size_t>(total), std::move(on_progress)));
+  source->worker_ = std::thread(&AsyncLoadSource::run, source.get(), path);
+  return source;
+}
+
+AsyncLoadSource::~AsyncLoadSource() {
+  stop_.store(true);
+  if (worker_.joinable())
+    worker_.join();
+}
+
+void AsyncLoadSource::run(std::string path) {
+  std::ifstream file(path, std::ios::binary);
+  size_t loaded = 0;
+  while (file && loaded < total_ && !stop_.load()) {
+    const size_t chunk = std::min(kChunkSize, total_ - loaded);
+    file.read(reinterpret_cast<char *>(bytes_.get() + loaded),
+              static_cast<std::streamsize>(chunk));
+    loaded += static_cast<size_t>(file.gcount());
+    loaded_.store(loaded, std::memory_order_release);
+    if (on_progress_)
+      on_progress_();
+  }
+  // 读取失败或被截断时停在已加载的前缀处
+  finish();
+}
+
+void AsyncLoadSource::finish() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    done_.store(true, std::memory_order_release);
+  }
+  done_cv_.notify_all();
+  if (on_progress_)
+    on_progress_();
+}
+
+void AsyncLoadSource::wait() const {
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_cv_.wait(lock, [this] { return done_.load(); });
+}
+
+size_t AsyncLoadSource::read(size_t pos, uint8_t *dst, size_t n) const {
+  const size_t loaded = size();
+  if (pos >= loaded)
+    return 0;
+  n = std::min(n, loaded - pos);
+  std::memcpy(dst, bytes_.get() + pos, n);
+  return n;
+}
+
+std::shared_ptr<DataSource> open_data_source(const std::string &path,
+                                             const OpenOptions &options) {
+  if (auto pid = ProcMemSource::parse_pid(path)) {
+    if (auto process = ProcMemSource::open(*pid))
+      return process;
+    throw std::runtime_error(fmt::format("Cannot read memory of process {}: {}",
+                                         *pid, std::strerror(errno)));
+  }
+  if (StreamSource::is_stream(path)) {
+    if (auto stream = StreamSource::open(path, options.memory_limit,
+                                         options.on_progress))
+      return stream;
+  }
+#ifdef BIN_READER_WITH_ZLIB
+  if (options.gunzip) {
+    if (auto gz = GzipSource::open(path, options.gz_span, options.cache_bytes,
+                                   options.on_progress))
+      return gz;
+  }
+#endif
+  if (options.preload) {
+    if (auto loader = AsyncLoadSource::open(path, options.on_progress))
+      return loader;
+  }
+  if (options.use_mmap) {
+    if (auto mapped = MmapSource::open(path))
+      return mapped;
+  }
+  if (auto cached = BlockCacheSource::open(path, options.cache_bytes))
+    return cached;
+  return std::make_shared<MemorySource>(Utils::read_binary_file(path));
+}
+
+// —— DataBuffer —— //
+void DataBuffer::resize(size_t n, uint8_t value) {
+  std::vector<uint8_t> bytes(n, value);
+  if (source_)
+    source_->read(0, bytes.data(), std::min(n, source_->size()));
+  *this = std::move(bytes);
+}
+
+void DataBuffer::require(size_t pos, size_t n) const {
+  // 先取 loading 再取 size：加载状态快照为 false 时 size 已是最终值
+  const bool pending = loading();
+  const size_t total = size();
+  if (n > total || pos > total - n) {
+    if (pending)
+      throw DataPendingError();
+    throw std::out_of_range("Attempt to read beyond data bounds");
+  }
+}
+
+void DataBuffer::copy(size_t pos, void *dst, size_t n) const {
+  require(pos, n);
+  if (n == 0)
+    return;
+  if (base_) {
+    std::memcpy(dst, base_ + pos, n);
+    return;
+  }
+  if (source_->read(pos, static_cast<uint8_t *>(dst), n) != n) {
+    throw std::runtime_error("Data source read error");
+  }
+}
@@ -0,0 +1,455 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/// 读取的区间尚未加载完成（后台加载中），稍后重试即可
+class DataPendingError : public std::runtime_error {
+public:
+  DataPendingError() : std::runtime_error("Data still loading") {}
+};
+
+// ========== Extent / ExtentMap ==========
+/// 一段连续的区间 [offset, offset + length)
+struct Extent {
+  size_t offset = 0;
+  size_t length = 0;
+
+  [[nodiscard]] size_t end() const { return offset + length; }
+};
+
+/// 数据源中的一个命名区段（拼接的文件、进程的映射区域）
+struct Segment {
+  size_t offset = 0;
+  size_t length = 0;
+  std::string name; // 文件名（不含目录）或映射名
+};
+
+/// 稀疏数据源的数据区段表（按偏移升序、互不重叠），区段之间为空洞。
+/// 所有查询都是对区段表的二分查找
+class ExtentMap {
+public:
+  ExtentMap(std::vector<Extent> data, size_t size)
+      : data_(std::move(data)), size_(size) {}
+
+  /// pos 位于空洞中时返回该空洞的区间
+  [[nodiscard]] std::optional<Extent> hole_at(size_t pos) const;
+
+  /// pos 之后下一个数据区段的起点
+  [[nodiscard]] std::optional<size_t> next_data(size_t pos) const;
+
+  /// pos 所在（或之前）数据区段的前一个区段起点；pos 位于空洞中时
+  /// 返回空洞之前那个区段的起点
+  [[nodiscard]] std::optional<size_t> prev_data(size_t pos) const;
+
+  [[nodiscard]] const std::vector<Extent> &data() const { return data_; }
+  [[nodiscard]] size_t size() const { return size_; }
+
+private:
+  std::vector<Extent> data_;
+  size_t size_ = 0;
+};
+
+// ========== DataSource 抽象基类 ==========
+/// 只读字节源：AppState 所有的读取、HexView 与 DataPreviewBar 的渲染都经由它访问
+/// 文件内容，具体实现可以是内存缓冲区、mmap 映射等
+class DataSource {
+public:
+  virtual ~DataSource() = default;
+
+  /// 当前可访问的字节数
+  [[nodiscard]] virtual size_t size() const = 0;
+
+  /// 从 pos 处拷贝最多 n 个字节到 dst，返回实际拷贝的字节数（越过末尾时截断）
+  virtual size_t read(size_t pos, uint8_t *dst, size_t n) const = 0;
+
+  /// 若整个数据源在内存中连续可直接访问，返回首地址；否则返回 nullptr
+  [[nodiscard]] virtual const uint8_t *contiguous() const { return nullptr; }
+
+  /// 是否仍在后台加载（size() 还会继续增长）
+  [[nodiscard]] virtual bool loading() const { return false; }
+
+  /// 重新检查底层文件大小并扩展可访问区域（不重新读取已有字节），
+  /// 返回新的 size()；不支持增长的数据源保持不变
+  virtual size_t refresh() { return size(); }
+
+  /// 数据区段表；没有空洞（或无法探测）时返回 nullptr
+  [[nodiscard]] virtual std::shared_ptr<const ExtentMap> extents() const {
+    return nullptr;
+  }
+
+  /// 内容是否可能随时变化（如运行中进程的内存）；为 true 时渲染结果不应缓存
+  [[nodiscard]] virtual bool live() const { return false; }
+
+  /// 已经可读的字节是否不会再变（内容已完整保存在本进程中）。底层文件
+  /// 可能被原地改写的数据源（mmap、按块读取、gzip）以及 live 的数据源
+  /// 返回 false；读取历史据此决定字符串只记位置还是拷贝内容
+  [[nodiscard]] virtual bool immutable() const { return false; }
+
+  /// [pos, pos+n) 是否不必先打开其他文件就能读取；后台统计据此跳过
+  /// 尚未打开的部分（如拼接中还没访问过的文件段）
+  [[nodiscard]] virtual bool resident(size_t /*pos*/, size_t /*n*/) const {
+    return true;
+  }
+
+  /// 提示 [pos, pos+n) 即将被访问：发起异步预读后立即返回，不阻塞调用方。
+  /// 数据已在内存中的数据源忽略该提示
+  virtual void advise(size_t /*pos*/, size_t /*n*/) const {}
+
+  /// 取出并清除最近一次无法恢复的读取错误（如拼接中的文件段在打开后被
+  /// 删除）；没有时返回空串。出错的部分按 0 读出，调用方只需显示该说明
+  virtual std::string take_error() { return {}; }
+
+  /// 由多个命名区段组成时（拼接的文件、进程的映射区域）返回各区段
+  /// （按偏移升序，打开后不再变化）；单个文件返回 nullptr
+  [[nodiscard]] virtual const std::vector<Segment> *segments() const {
+    return nullptr;
+  }
+};
+
+// ========== MemorySource ==========
+/// 数据完全保存在 std::vector 中（测试、小文件以及无法 mmap 时的兜底方案）
+class MemorySource : public DataSource {
+public:
+  MemorySource() = default;
+  explicit MemorySource(std::vector<uint8_t> bytes)
+      : bytes_(std::move(bytes)) {}
+
+  [[nodiscard]] size_t size() const override { return bytes_.size(); }
+  size_t read(size_t pos, uint8_t *dst, size_t n) const override;
+  [[nodiscard]] const uint8_t *contiguous() const override {
+    return bytes_.data();
+  }
+  [[nodiscard]] bool immutable() const override { return true; }
+
+private:
+  std::vector<uint8_t> bytes_;
+};
+
+// ========== MmapSource ==========
+/// 只读 mmap 映射整个文件：打开为 O(1)，内存与内核页缓存共享，
+/// 可以浏览比物理内存更大的文件
+class MmapSource : public DataSource {
+public:
+  /// 映射 path 指向的普通文件；映射失败（特殊文件等）时返回 nullptr。
+  /// 空文件可以打开，待 refresh() 发现文件增长后再建立映射
+  static std::unique_ptr<MmapSource> open(const std::string &path);
+
+  ~MmapSource() override;
+  MmapSource(const MmapSource &) = delete;
+  MmapSource &operator=(const MmapSource &) = delete;
+
+  [[nodiscard]] size_t size() const override {
+    return size_.load(std::memory_order_acquire);
+  }
+  size_t read(size_t pos, uint8_t *dst, size_t n) const override;
+  [[nodiscard]] const uint8_t *contiguous() const override {
+    return base_.load(std::memory_order_acquire);
+  }
+
+  /// 文件变大时扩展可访问范围：映射时预留了余量，余量内的增长只需更新
+  /// size；超出余量才建立新的映射。映射失败时抛出 std::runtime_error。
+  /// 文件被截断时把各映射中超出新末尾的页换成零页，仍按旧大小读取的
+  /// 线程读到 0 而不是触发 SIGBUS
+  size_t refresh() override;
+
+  /// madvise(MADV_WILLNEED)：内核在后台把对应页读入页缓存
+  void advise(size_t pos, size_t n) const override;
+
+  [[nodiscard]] std::shared_ptr<const ExtentMap> extents() const override {
+    return std::atomic_load(&extents_);
+  }
+
+private:
+  explicit MmapSource(int fd) : fd_(fd) {}
+
+  /// 超出映射末尾后至少再预留的字节数（按当前大小的一半与此值取大）
+  static constexpr size_t kMinReserve = 16 << 20;
+  struct Mapping {
+    void *addr = nullptr;
+    size_t length = 0; // 映射的总长度
+    size_t backed = 0; // 开头仍映射着文件的字节数（其后为零页）
+  };
+
+  /// 映射至少 size 字节（尽量带上预留的余量）并发布为当前映射，
+  /// 之前的映射移入 retired_
+  bool map(size_t size);
+  /// 把 m 中 size 之后的整页换成匿名零页
+  static void cover_past(Mapping &m, size_t size);
+
+  int fd_ = -1;
+  // 先发布 base_ 再发布 size_：读到新 size 的线程一定能读到对应的 base
+  std::atomic<const uint8_t *> base_{nullptr};
+  std::atomic<size_t> size_{0};
+  Mapping current_; // 当前映射（length 含预留的余量）
+  // 被替换的旧映射：其他线程（后台统计、DataBuffer 缓存的 base）可能仍在
+  // 读取，无法得知何时用完，保留到析构时才解除；预留余量使重新映射很少发生
+  std::vector<Mapping> retired_;
+  std::shared_ptr<const ExtentMap> extents_; // 稀疏文件的数据区段
+};
+
+// ========== BlockCacheSource ==========
+/// 分块按需读取（pread）的数据源：固定大小的块放在有上限的 LRU 缓存中，
+/// 用于 FUSE/NFS、块设备等无法 mmap 或 mmap 很慢的文件，内存占用与文件大小无关
+class BlockCacheSource : public DataSource {
+public:
+  static constexpr size_t kDefaultBlockSize = 64 * 1024;
+
+  /// 打开 path；capacity_bytes 为缓存上限（至少保留一个块），
+  /// 无法确定大小（或非普通文件大小为 0）时返回 nullptr
+  static std::unique_ptr<BlockCacheSource>
+  open(const std::string &path, size_t capacity_bytes,
+       size_t block_size = kDefaultBlockSize);
+
+  ~BlockCacheSource() override;
+  BlockCacheSource(const BlockCacheSource &) = delete;
+  BlockCacheSource &operator=(const BlockCacheSource &) = delete;
+
+  [[nodiscard]] size_t size() const override {
+    return size_.load(std::memory_order_acquire);
+  }
+  size_t read(size_t pos, uint8_t *dst, size_t n) const override;
+
+  /// 文件变大时扩展 size()，并丢弃此前不完整的末尾块
+  size_t refresh() override;
+
+  /// posix_fadvise(POSIX_FADV_WILLNEED)：内核异步预读到页缓存，
+  /// 之后的 pread 不再等待磁盘/网络
+  void advise(size_t pos, size_t n) const override;
+
+  [[nodiscard]] std::shared_ptr<const ExtentMap> extents() const override {
+    return std::atomic_load(&extents_);
+  }
+
+  /// 当前缓存中的块数
+  [[nodiscard]] size_t cached_blocks() const;
+
+private:
+  struct Block {
+    size_t index;
+    std::vector<uint8_t> bytes;
+  };
+
+  BlockCacheSource(int fd, size_t size, size_t block_size, size_t max_blocks)
+      : fd_(fd), size_(size), block_size_(block_size),
+        max_blocks_(max_blocks) {}
+
+  /// 取得第 index 块（必要时从磁盘读入并淘汰最久未用的块），调用方需持有锁
+  const Block &fetch(size_t index) const;
+
+  int fd_ = -1;
+  std::atomic<size_t> size_{0};
+  size_t block_size_ = kDefaultBlockSize;
+  size_t max_blocks_ = 1;
+
+  mutable std::mutex mutex_;
+  mutable std::list<Block> lru_; // 头部为最近使用
+  mutable std::unordered_map<size_t, std::list<Block>::iterator> index_;
+  std::shared_ptr<const ExtentMap> extents_; // 稀疏文件的数据区段
+};
+
+// ========== AsyncLoadSource ==========
+/// 在后台线程把整个文件读入内存：size() 为已加载前缀的长度并随加载增长，
+/// 首屏无需等待整个文件读完
+class AsyncLoadSource : public DataSource {
+public:
+  /// 打开 path 并立即开始后台加载；每加载一段调用一次 on_progress
+  /// （在加载线程中调用）
+  static std::unique_ptr<AsyncLoadSource>
+  open(const std::string &path, std::function<void()> on_progress = {});
+
+  ~AsyncLoadSource() override;
+  AsyncLoadSource(const AsyncLoadSource &) = delete;
+  AsyncLoadSource &operator=(const AsyncLoadSource &) = delete;
+
+  [[nodiscard]] size_t size() const override {
+    return loaded_.load(std::memory_order_acquire);
+  }
+  size_t read(size_t pos, uint8_t *dst, size_t n) const override;
+  [[nodiscard]] const uint8_t *contiguous() const override {
+    return bytes_.get();
+  }
+  [[nodiscard]] bool loading() const override {
+    return !done_.load(std::memory_order_acquire);
+  }
+  [[nodiscard]] bool immutable() const override { return true; }
+
+  /// 文件总大小
+  [[nodiscard]] size_t total_size() const { return total_; }
+
+  /// 阻塞直到加载结束
+  void wait() const;
+
+private:
+  static constexpr size_t kChunkSize = 4 * 1024 * 1024;
+
+  AsyncLoadSource(size_t total, std::function<void()> on_progress)
+      : bytes_(new uint8_t[total]), total_(total),
+        on_progress_(std::move(on_progress)) {}
+
+  void run(std::string path);
+  void finish();
+
+  std::unique_ptr<uint8_t[]> bytes_; // 预先按总大小分配，地址保持不变
+  size_t total_ = 0;
+  std::atomic<size_t> loaded_{0};
+  std::atomic<bool> done_{false};
+  std::atomic<bool> stop_{false};
+  std::function<void()> on_progress_;
+  mutable std::mutex mutex_;
+  mutable std::condition_variable done_cv_;
+  std::thread worker_;
+};
+
+/// 用 SEEK_DATA/SEEK_HOLE 探测 fd 的数据区段；文件系统不支持或没有空洞时
+/// 返回 nullptr。耗时与区段数成正比，不读取文件内容
+std::shared_ptr<const ExtentMap> scan_extents(int fd, size_t size);
+
+/// 打开数据源时的选项
+struct OpenOptions {
+  bool use_mmap = true;                       // 是否尝试 mmap
+  bool preload = false;                       // 后台把整个文件读入内存
+  bool gunzip = true;                         // 透明解压 .gz 文件
+  size_t gz_span = 16ull * 1024 * 1024;       // gzip 检查点间隔
+  size_t cache_bytes = 64ull * 1024 * 1024;   // 分块缓存上限
+  size_t memory_limit = 256ull * 1024 * 1024; // 流式输入在内存中保留的上限
+  std::function<void()> on_progress;          // 后台加载有进展时的回调
+};
+
+/// 根据路径打开最合适的数据源："pid:N" 读取进程内存；"-" 与管道按流读取；gzip 文件按检查点索引
+/// 随机解压；指定 preload 时后台加载；否则优先 mmap，其次分块缓存，
+/// 最后整体读入内存
+std::shared_ptr<DataSource> open_data_source(const std::string &path,
+                                             const OpenOptions &options = {});
+
+// ========== DataBuffer ==========
+/// AppState::data 的值类型包装：对外保持类似 std::vector<uint8_t> 的接口
+/// （size/empty/operator[]/resize/初始化列表赋值），内部转发给 DataSource
+class DataBuffer {
+public:
+  DataBuffer() = default;
+  DataBuffer(std::initializer_list<uint8_t> bytes) { *this = bytes; }
+
+  DataBuffer &operator=(std::initializer_list<uint8_t> bytes) {
+    return *this = std::vector<uint8_t>(bytes);
+  }
+  DataBuffer &operator=(std::vector<uint8_t> bytes) {
+    reset(std::make_shared<MemorySource>(std::move(bytes)));
+    return *this;
+  }
+
+  /// 替换底层数据源
+  void reset(std::shared_ptr<DataSource> source) {
+    source_ = std::move(source);
+    base_ = source_ ? source_->contiguous() : nullptr;
+    ++generation_;
+  }
+
+  /// 调整大小（内容拷贝进新的内存数据源，仅用于测试和小数据）
+  void resize(size_t n, uint8_t value = 0);
+
+  [[nodiscard]] size_t size() const { return source_ ? source_->size() : 0; }
+  [[nodiscard]] bool empty() const { return size() == 0; }
+
+  /// 读取单个字节，调用方保证 pos < size()
+  uint8_t operator[](size_t pos) const {
+    if (base_)
+      return base_[pos];
+    uint8_t byte = 0;
+    source_->read(pos, &byte, 1);
+    return byte;
+  }
+
+  /// 拷贝 [pos, pos + n) 到 dst，越界时抛出 std::out_of_range；
+  /// 区间尚在后台加载时抛出 DataPendingError
+  void copy(size_t pos, void *dst, size_t n) const;
+
+  /// 只做 copy 的越界检查（抛出同样的异常），不读取数据
+  void require(size_t pos, size_t n) const;
+
+  /// 拷贝 [pos, pos + n) 中实际存在的部分到 dst，返回拷贝的字节数
+  /// （越过末尾时截断，不抛异常；用于渲染）
+  size_t read(size_t pos, uint8_t *dst, size_t n) const {
+    const size_t total = size();
+    if (pos >= total)
+      return 0;
+    n = std::min(n, total - pos);
+    if (base_) {
+      std::memcpy(dst, base_ + pos, n);
+      return n;
+    }
+    return source_->read(pos, dst, n);
+  }
+
+  /// 内容是否可能随时变化，见 DataSource::live
+  [[nodiscard]] bool live() const { return source_ && source_->live(); }
+
+  /// 见 DataSource::take_error
+  std::string take_error() { return source_ ? source_->take_error() : ""; }
+
+  /// 已读取的字节是否不会再变，见 DataSource::immutable
+  [[nodiscard]] bool immutable() const {
+    return !source_ || source_->immutable();
+  }
+
+  /// 数据版本号：替换数据源或 refresh 后递增，供渲染缓存判断失效
+  [[nodiscard]] uint64_t generation() const { return generation_; }
+
+  /// 数据源是否仍在加载
+  [[nodiscard]] bool loading() const { return source_ && source_->loading(); }
+
+  /// 让数据源重新检查文件大小，返回新增的字节数。大小变化，或 modified
+  /// （监视方报告文件被写入，可能是原地修改）时数据版本号递增
+  size_t refresh(bool modified = false) {
+    if (!source_)
+      return 0;
+    const size_t before = size();
+    const size_t after = source_->refresh();
+    base_ = source_->contiguous();
+    if (modified || after != before)
+      ++generation_;
+    return after > before ? after - before : 0;
+  }
+
+  /// 提示即将访问 [pos, pos+n)，见 DataSource::advise
+  void advise(size_t pos, size_t n) const {
+    if (source_)
+      source_->advise(pos, n);
+  }
+
+  /// 拼接的文件段（单个文件时为 nullptr）
+  [[nodiscard]] const std::vector<Segment> *segments() const {
+    return source_ ? source_->segments() : nullptr;
+  }
+
+  /// 数据区段表（没有空洞时为 nullptr）
+  [[nodiscard]] std::shared_ptr<const ExtentMap> extents() const {
+    return source_ ? source_->extents() : nullptr;
+  }
+
+  [[nodiscard]] const DataSource *source() const { return source_.get(); }
+
+  /// 与后台任务共享数据源的所有权（任务运行期间数据源被替换也不会失效）
+  [[nodiscard]] std::shared_ptr<const DataSource> shared_source() const {
+    return source_;
+  }
+
+private:
+  std::shared_ptr<DataSource> source_;
+  const uint8_t *base_ = nullptr; // 数据连续时缓存首地址，省去虚函数调用
+  uint64_t generation_ = 0;
+};
@@ -28,7 +28,7 @@ EventHandlerFn HandleNavigation(AppState &state,
       cmd.type = CommandType::MoveDown;
 
     if (event.character() == ".") {
-      state.apply_command(state.last_command);
+      state.queue_command(state.last_command);
       return true;
     }
 
@@ -36,9 +36,9 @@ EventHandlerFn HandleNavigation(AppState &state,
       screen.Exit();
       return true;
     }
-    // 记录并执行新命令
+    // 记录新命令，合并到本帧的批次中执行
     state.last_command = cmd;
-    state.apply_command(cmd);
+    state.queue_command(cmd);
     return true;
   };
 }
@@ -47,6 +47,8 @@ EventHandlerFn HandleCommands(AppState &state, std::string &command_input,
                               ftxui::ScreenInteractive &screen) {
   return [&](const Event &event) {
     if (event == Event::Return) {
+      // 先执行尚未 flush 的导航，命令看到的是最新的光标位置
+      state.flush_commands();
       ParsedCommand cmd = ParsedCommand::parse(command_input);
       bool handled = CommandRegistry::instance().dispatch(cmd, state);
 
@@ -0,0 +1,82 @@
+#include "FileWatcher.hpp"
+
+#include <chrono>
+#include <filesystem>
+#include <utility>
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#define BIN_READER_INOTIFY 1
+#endif
+
+FileWatcher::FileWatcher(std::string path, Callback on_change)
+    : path_(std::move(path)), on_change_(std::move(on_change)) {
+#ifdef BIN_READER_INOTIFY
+  if (::pipe(wake_fds_) != 0)
+    wake_fds_[0] = wake_fds_[1] = -1;
+#endif
+  worker_ = std::thread(&FileWatcher::run, this);
+}
+
+FileWatcher::~FileWatcher() {
+  stop_.store(true);
+#ifdef BIN_READER_INOTIFY
+  if (wake_fds_[1] >= 0) {
+    const char byte = 0;
+    [[maybe_unused]] auto n = ::write(wake_fds_[1], &byte, 1);
+  }
+#endif
+  if (worker_.joinable())
+    worker_.join();
+#ifdef BIN_READER_INOTIFY
+  for (int fd : wake_fds_)
+    if (fd >= 0)
+      ::close(fd);
+#endif
+}
+
+void FileWatcher::run() {
+#ifdef BIN_READER_INOTIFY
+  int inotify_fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (inotify_fd >= 0 &&
+      ::inotify_add_watch(inotify_fd, path_.c_str(),
+                          IN_MODIFY | IN_CLOSE_WRITE) >= 0 &&
+      wake_fds_[0] >= 0) {
+    alignas(struct inotify_event) char buf[4096];
+    while (!stop_.load()) {
+      pollfd fds[2] = {{inotify_fd, POLLIN, 0}, {wake_fds_[0], POLLIN, 0}};
+      if (::poll(fds, 2, -1) <= 0)
+        continue;
+      if (fds[1].revents)
+        break;
+      // 一次读空队列：一批事件只触发一次回调
+      bool changed = false;
+      while (::read(inotify_fd, buf, sizeof(buf)) > 0)
+        changed = true;
+      if (changed && !stop_.load())
+        on_change_();
+    }
+    ::close(inotify_fd);
+    return;
+  }
+  if (inotify_fd >= 0)
+    ::close(inotify_fd);
+#endif
+  // 无 inotify 时定时轮询，只在修改时间或大小变化时回调
+  auto stamp = [this] {
+    std::error_code ec;
+    const auto mtime = std::filesystem::last_write_time(path_, ec);
+    const auto size = std::filesystem::file_size(path_, ec);
+    return std::make_pair(mtime, size);
+  };
+  auto last = stamp();
+  while (!stop_.load()) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    const auto now = stamp();
+    if (now != last && !stop_.load())
+      on_change_();
+    last = now;
+  }
+}
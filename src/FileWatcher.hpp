@@ -0,0 +1,30 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <thread>
+
+// ========== FileWatcher ==========
+/// 在后台线程监视文件变化（Linux 上使用 inotify，其他平台定时轮询修改
+/// 时间与大小），文件被追加/修改时调用回调；回调在监视线程中执行
+class FileWatcher {
+public:
+  using Callback = std::function<void()>;
+
+  FileWatcher(std::string path, Callback on_change);
+  ~FileWatcher();
+  FileWatcher(const FileWatcher &) = delete;
+  FileWatcher &operator=(const FileWatcher &) = delete;
+
+  [[nodiscard]] const std::string &path() const { return path_; }
+
+private:
+  void run();
+
+  std::string path_;
+  Callback on_change_;
+  std::atomic<bool> stop_{false};
+  int wake_fds_[2] = {-1, -1}; // 析构时写入以唤醒阻塞中的监视线程
+  std::thread worker_;
+};
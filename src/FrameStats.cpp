@@ -0,0 +1,131 @@
+#include "FrameStats.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+
+// —— 分配计数 —— //
+// 替换全局 operator new 会影响整个程序：即使统计关闭，每次分配也多一次
+// 原子加法，还会与 sanitizer 等自带的分配器冲突。因此只在以
+// BIN_READER_ALLOC_STATS 构建时启用（CMake 选项，默认关闭），否则 HUD 不显示
+// 分配次数
+#ifdef BIN_READER_ALLOC_STATS
+namespace {
+std::atomic<uint64_t> g_allocations{0};
+
+void *counted_alloc(std::size_t size) {
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void *p = std::malloc(size == 0 ? 1 : size))
+    return p;
+  throw std::bad_alloc();
+}
+} // namespace
+
+void *operator new(std::size_t size) { return counted_alloc(size); }
+void *operator new[](std::size_t size) { return counted_alloc(size); }
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+#endif
+
+uint64_t FrameStats::allocation_count() {
+#ifdef BIN_READER_ALLOC_STATS
+  return g_allocations.load(std::memory_order_relaxed);
+#else
+  return 0;
+#endif
+}
+
+const char *FrameStats::section_name(FrameSection section) {
+  static constexpr std::array<const char *, kFrameSectionCount> kNames = {
+      "status", "hex", "minimap", "preview", "history", "data"};
+  return kNames[static_cast<size_t>(section)];
+}
+
+void FrameStats::set_enabled(bool on) {
+  if (on && !enabled_) {
+    count_ = 0;
+    next_ = 0;
+    last_ = Frame{};
+  }
+  enabled_ = on;
+  in_frame_ = false;
+}
+
+void FrameStats::begin_frame() {
+  if (!enabled_)
+    return;
+  in_frame_ = true;
+  current_ = Frame{};
+  frame_allocations_ = allocation_count();
+  frame_start_ = Clock::now();
+}
+
+void FrameStats::end_frame() {
+  if (!enabled_ || !in_frame_)
+    return;
+  in_frame_ = false;
+  current_.total_ms =
+      std::chrono::duration<double, std::milli>(Clock::now() - frame_start_)
+          .count();
+  current_.allocations = allocation_count() - frame_allocations_;
+  last_ = current_;
+  window_[next_] = current_;
+  next_ = (next_ + 1) % kWindow;
+  count_ = std::min(count_ + 1, kWindow);
+}
+
+void FrameStats::add_time(FrameSection section, Clock::duration elapsed) {
+  if (in_frame_)
+    current_.ms[static_cast<size_t>(section)] +=
+        std::chrono::duration<double, std::milli>(elapsed).count();
+}
+
+void FrameStats::add_elements(FrameSection section, size_t count) {
+  if (in_frame_)
+    current_.elements[static_cast<size_t>(section)] += count;
+}
+
+double FrameStats::percentile(double p) const {
+  if (count_ == 0)
+    return 0;
+  std::vector<double> totals;
+  totals.reserve(count_);
+  for (size_t i = 0; i < count_; ++i)
+    totals.push_back(window_[i].total_ms);
+  // 最近邻秩：第 ceil(p/100 * n) 小的值
+  const auto rank = static_cast<size_t>(
+      std::ceil(std::clamp(p, 0.0, 100.0) / 100 * static_cast<double>(count_)));
+  const size_t k = rank == 0 ? 0 : rank - 1;
+  std::nth_element(totals.begin(), totals.begin() + static_cast<long>(k),
+                   totals.end());
+  return totals[k];
+}
+
+bool FrameStats::dump(const std::string &path) const {
+  std::ofstream out(path);
+  if (!out)
+    return false;
+  out << "frame,total_ms,allocations";
+  for (size_t s = 0; s < kFrameSectionCount; ++s) {
+    const char *name = section_name(static_cast<FrameSection>(s));
+    out << ',' << name << "_ms," << name << "_elements";
+  }
+  out << '\n';
+  // 窗口未满时从 0 开始，满了从最早的一帧（next_）开始
+  const size_t first = count_ < kWindow ? 0 : next_;
+  for (size_t i = 0; i < count_; ++i) {
+    const Frame &f = window_[(first + i) % kWindow];
+    out << i << ',' << f.total_ms << ',' << f.allocations;
+    for (size_t s = 0; s < kFrameSectionCount; ++s)
+      out << ',' << f.ms[s] << ',' << f.elements[s];
+    out << '\n';
+  }
+  out << "# p50_ms," << percentile(50) << "\n# p99_ms," << percentile(99)
+      << '\n';
+  return static_cast<bool>(out);
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// 渲染耗时统计的分项
+enum class FrameSection : uint8_t {
+  StatusBar,
+  HexView,
+  Minimap,
+  DataPreview,
+  History,
+  Data, // 渲染期间读取数据源的时间（同时计入所在面板）
+};
+
+inline constexpr size_t kFrameSectionCount = 6;
+
+// ========== FrameStats ==========
+/// 逐帧渲染统计（单例，只在 UI 线程使用）：每帧的总耗时、分配次数，
+/// 以及各面板构建 + 布局 + 绘制的耗时与搭建的元素数（行数等）。
+/// 最近 kWindow 帧保存在环形缓冲区中，用于计算 p50/p99 和导出 CSV。
+/// 关闭时各计时点只检查一次 enabled()
+class FrameStats {
+public:
+  using Clock = std::chrono::steady_clock;
+  static constexpr size_t kWindow = 256;
+
+  struct Frame {
+    double total_ms = 0;
+    uint64_t allocations = 0;
+    std::array<double, kFrameSectionCount> ms{};
+    std::array<size_t, kFrameSectionCount> elements{};
+  };
+
+  /// 在作用域结束时把经过的时间计入 section
+  class Scope {
+  public:
+    explicit Scope(FrameSection section)
+        : section_(section), enabled_(instance().enabled()) {
+      if (enabled_)
+        start_ = Clock::now();
+    }
+    ~Scope() {
+      if (enabled_)
+        instance().add_time(section_, Clock::now() - start_);
+    }
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+  private:
+    FrameSection section_;
+    bool enabled_;
+    Clock::time_point start_;
+  };
+
+  static FrameStats &instance() {
+    static FrameStats inst;
+    return inst;
+  }
+
+  [[nodiscard]] bool enabled() const { return enabled_; }
+  /// 开启或关闭统计；重新开启时清空之前的记录
+  void set_enabled(bool on);
+
+  /// 一帧开始（构建 Element 树之前）与结束（绘制完成之后）
+  void begin_frame();
+  void end_frame();
+
+  void add_time(FrameSection section, Clock::duration elapsed);
+  void add_elements(FrameSection section, size_t count);
+
+  /// 最近完成的一帧
+  [[nodiscard]] const Frame &last() const { return last_; }
+  /// 已记录的帧数（不超过 kWindow）
+  [[nodiscard]] size_t frames() const { return count_; }
+  /// 最近 kWindow 帧总耗时的百分位数（p 取 0~100），没有记录时为 0
+  [[nodiscard]] double percentile(double p) const;
+
+  /// 以 CSV 写出窗口内每一帧的数据（最早→最晚），末尾附 p50/p99
+  bool dump(const std::string &path) const;
+
+  /// 进程启动以来 operator new 的调用次数（未启用分配统计时为 0）
+  static uint64_t allocation_count();
+  /// 是否以 BIN_READER_ALLOC_STATS 构建、统计分配次数
+  static constexpr bool counts_allocations() {
+#ifdef BIN_READER_ALLOC_STATS
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  static const char *section_name(FrameSection section);
+
+private:
+  FrameStats() = default;
+
+  bool enabled_ = false;
+  bool in_frame_ = false;
+  Clock::time_point frame_start_;
+  uint64_t frame_allocations_ = 0;
+  Frame current_;
+  Frame last_;
+  std::vector<Frame> window_ = std::vector<Frame>(kWindow);
+  size_t next_ = 0;  // 下一帧写入 window_ 的位置
+  size_t count_ = 0;
+};
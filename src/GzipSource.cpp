@@ -0,0 +1,462 @@
+#include "GzipSource.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <zlib.h>
+
+namespace {
+constexpr size_t kInputChunk = 64 * 1024;
+constexpr size_t kGzipTrailer = 8;         // CRC32 + ISIZE
+constexpr int kAutoHeader = 15 + 32;       // 自动识别 gzip/zlib 头
+constexpr int kRawDeflate = -15;           // 无头的 raw deflate
+constexpr size_t kProgressStep = 16 << 20; // 每解压这么多字节通知一次进度
+constexpr char kSidecarMagic[8] = {'B', 'R', 'G', 'Z', 'I', 'D', 'X', '1'};
+
+template <typename T> void put(std::ofstream &out, const T &value) {
+  out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <typename T> bool get(std::ifstream &in, T &value) {
+  return static_cast<bool>(
+      in.read(reinterpret_cast<char *>(&value), sizeof(T)));
+}
+} // namespace
+
+/// 随机读取用的解压游标：持有 z_stream、输入文件和正在填充的块
+struct GzipSource::Cursor {
+  z_stream strm{};
+  bool initialized = false;
+  std::ifstream file;
+  std::vector<uint8_t> input = std::vector<uint8_t>(kInputChunk);
+  bool raw = false;           // 当前是否处于 raw deflate 模式
+  size_t skip_trailer = 0;    // raw 模式下成员结束后待跳过的尾部字节数
+  bool finished = false;      // 数据已结束或出错
+  uint64_t out = 0;           // 已解压到的输出偏移
+  uint64_t block_start = 0;   // 当前块的起始输出偏移（块对齐）
+  uint64_t discard = 0;       // 到达第一个块边界前需丢弃的字节数
+  std::vector<uint8_t> block; // 当前块
+  size_t fill = 0;            // 当前块已填充的字节数
+
+  ~Cursor() {
+    if (initialized)
+      inflateEnd(&strm);
+  }
+};
+
+bool GzipSource::is_gzip(const std::string &path) {
+  std::ifstream file(path, std::ios::binary);
+  unsigned char magic[2] = {};
+  return file.read(reinterpret_cast<char *>(magic), 2) && magic[0] == 0x1f &&
+         magic[1] == 0x8b;
+}
+
+GzipSource::GzipSource(std::string path, size_t span, size_t cache_bytes,
+                       std::function<void()> on_progress)
+    : path_(std::move(path)), span_(std::max(span, kWindowSize)),
+      max_blocks_(std::max<size_t>(2, cache_bytes / kBlockSize)),
+      on_progress_(std::move(on_progress)) {}
+
+std::unique_ptr<GzipSource>
+GzipSource::open(const std::string &path, size_t span, size_t cache_bytes,
+                 std::function<void()> on_progress) {
+  if (!is_gzip(path))
+    return nullptr;
+
+  std::error_code ec;
+  const auto compressed = std::filesystem::file_size(path, ec);
+  const auto mtime = std::filesystem::last_write_time(path, ec);
+  if (ec)
+    return nullptr;
+
+  std::unique_ptr<GzipSource> source(
+      new GzipSource(path, span, cache_bytes, std::move(on_progress)));
+  source->compressed_size_ = compressed;
+  source->mtime_ = static_cast<int64_t>(mtime.time_since_epoch().count());
+
+  if (source->load_sidecar()) {
+    source->from_sidecar_ = true;
+    source->indexed_all_.store(true, std::memory_order_release);
+  } else {
+    source->builder_ = std::thread(&GzipSource::build_index, source.get());
+  }
+  return source;
+}
+
+GzipSource::~GzipSource() {
+  stop_.store(true);
+  if (builder_.joinable())
+    builder_.join();
+}
+
+void GzipSource::wait() const {
+  std::unique_lock<std::mutex> lock(index_mutex_);
+  index_cv_.wait(lock, [this] { return indexed_all_.load(); });
+}
+
+size_t GzipSource::checkpoints() const {
+  std::lock_guard<std::mutex> lock(index_mutex_);
+  return points_.size();
+}
+
+// —— 建立索引 —— //
+void GzipSource::build_index() {
+  std::ifstream file(path_, std::ios::binary);
+  std::vector<uint8_t> input(kInputChunk);
+  std::vector<uint8_t> window(kWindowSize);
+
+  z_stream strm{};
+  bool ok = file && inflateInit2(&strm, kAutoHeader) == Z_OK;
+  if (ok) {
+    std::lock_guard<std::mutex> lock(index_mutex_);
+    points_.push_back(Checkpoint{0, 0, 0, true, {}});
+  }
+
+  uint64_t totin = 0;
+  uint64_t totout = 0;
+  uint64_t last = 0;
+  uint64_t next_progress = kProgressStep;
+  bool clean_end = false;
+
+  while (ok && !stop_.load()) {
+    if (strm.avail_in == 0) {
+      file.read(reinterpret_cast<char *>(input.data()),
+                static_cast<std::streamsize>(input.size()));
+      const auto got = static_cast<uInt>(file.gcount());
+      if (got == 0)
+        break;
+      strm.avail_in = got;
+      strm.next_in = input.data();
+    }
+    if (strm.avail_out == 0) {
+      strm.avail_out = static_cast<uInt>(kWindowSize);
+      strm.next_out = window.data();
+    }
+
+    totin += strm.avail_in;
+    totout += strm.avail_out;
+    const int ret = inflate(&strm, Z_BLOCK);
+    totin -= strm.avail_in;
+    totout -= strm.avail_out;
+
+    if (ret == Z_NEED_DICT || ret == Z_DATA_ERROR || ret == Z_MEM_ERROR) {
+      // 多成员文件末尾可能有填充的垃圾数据，此前解压出的内容仍然有效
+      break;
+    }
+
+    if (ret == Z_STREAM_END) {
+      clean_end = true;
+      if (strm.avail_in == 0) {
+        file.read(reinterpret_cast<char *>(input.data()),
+                  static_cast<std::streamsize>(input.size()));
+        strm.avail_in = static_cast<uInt>(file.gcount());
+        strm.next_in = input.data();
+        if (strm.avail_in == 0)
+          break;
+      }
+      // 拼接的下一个 gzip 成员：从其头部开始记录一个检查点
+      inflateReset(&strm);
+      clean_end = false;
+      std::lock_guard<std::mutex> lock(index_mutex_);
+      points_.push_back(Checkpoint{totout, totin, 0, true, {}});
+      last = totout;
+      continue;
+    }
+
+    // 在 deflate 块头之后（且不是最后一个块）记录检查点
+    if ((strm.data_type & 128) && !(strm.data_type & 64) &&
+        totout - last > span_) {
+      Checkpoint point{totout, totin, strm.data_type & 7, false,
+                       std::vector<uint8_t>(kWindowSize)};
+      const size_t left = strm.avail_out;
+      if (left)
+        std::memcpy(point.window.data(), window.data() + kWindowSize - left,
+                    left);
+      if (left < kWindowSize)
+        std::memcpy(point.window.data() + left, window.data(),
+                    kWindowSize - left);
+      std::lock_guard<std::mutex> lock(index_mutex_);
+      points_.push_back(std::move(point));
+      last = totout;
+    }
+
+    indexed_.store(totout, std::memory_order_release);
+    if (totout >= next_progress) {
+      next_progress = totout + kProgressStep;
+      if (on_progress_)
+        on_progress_();
+    }
+  }
+  inflateEnd(&strm);
+
+  indexed_.store(totout, std::memory_order_release);
+  {
+    std::lock_guard<std::mutex> lock(index_mutex_);
+    indexed_all_.store(true, std::memory_order_release);
+  }
+  index_cv_.notify_all();
+  if (clean_end && !stop_.load())
+    save_sidecar();
+  if (on_progress_)
+    on_progress_();
+}
+
+// —— 旁路索引文件 —— //
+bool GzipSource::load_sidecar() {
+  std::ifstream in(sidecar_path(path_), std::ios::binary);
+  char magic[sizeof(kSidecarMagic)] = {};
+  uint64_t compressed = 0, span = 0, total = 0, count = 0;
+  int64_t mtime = 0;
+  if (!in.read(magic, sizeof(magic)) ||
+      std::memcmp(magic, kSidecarMagic, sizeof(magic)) != 0 ||
+      !get(in, compressed) || !get(in, mtime) || !get(in, span) ||
+      !get(in, total) || !get(in, count))
+    return false;
+  // 检查点数不可能超过压缩数据的字节数，防止损坏的索引导致巨量分配
+  if (compressed != compressed_size_ || mtime != mtime_ || span != span_ ||
+      count > compressed_size_)
+    return false;
+
+  std::vector<Checkpoint> points(count);
+  for (auto &point : points) {
+    uint8_t header = 0;
+    uint32_t window_size = 0;
+    if (!get(in, point.out) || !get(in, point.in) || !get(in, point.bits) ||
+        !get(in, header) || !get(in, window_size) || window_size > kWindowSize)
+      return false;
+    point.header = header != 0;
+    point.window.resize(window_size);
+    if (!in.read(reinterpret_cast<char *>(point.window.data()), window_size))
+      return false;
+  }
+
+  std::lock_guard<std::mutex> lock(index_mutex_);
+  points_ = std::move(points);
+  indexed_.store(static_cast<size_t>(total), std::memory_order_release);
+  return true;
+}
+
+void GzipSource::save_sidecar() const {
+  // 先写临时文件再改名，避免留下不完整的索引；目录不可写时忽略
+  const std::string target = sidecar_path(path_);
+  const std::string temp = target + ".tmp";
+  {
+    std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+    if (!out)
+      return;
+    std::lock_guard<std::mutex> lock(index_mutex_);
+    out.write(kSidecarMagic, sizeof(kSidecarMagic));
+    put(out, compressed_size_);
+    put(out, mtime_);
+    put(out, static_cast<uint64_t>(span_));
+    put(out, static_cast<uint64_t>(size()));
+    put(out, static_cast<uint64_t>(points_.size()));
+    for (const auto &point : points_) {
+      put(out, point.out);
+      put(out, point.in);
+      put(out, point.bits);
+      put(out, static_cast<uint8_t>(point.header));
+      put(out, static_cast<uint32_t>(point.window.size()));
+      out.write(reinterpret_cast<const char *>(point.window.data()),
+                static_cast<std::streamsize>(point.window.size()));
+    }
+    if (!out)
+      return;
+  }
+  std::error_code ec;
+  std::filesystem::rename(temp, target, ec);
+  if (ec)
+    std::filesystem::remove(temp, ec);
+}
+
+// —— 随机读取 —— //
+bool GzipSource::restart(size_t target) const {
+  Checkpoint point;
+  {
+    std::lock_guard<std::mutex> lock(index_mutex_);
+    auto it = std::upper_bound(
+        points_.begin(), points_.end(), target,
+        [](size_t pos, const Checkpoint &p) { return pos < p.out; });
+    if (it == points_.begin())
+      return false;
+    point = *std::prev(it);
+  }
+
+  if (!cursor_)
+    cursor_ = std::make_unique<Cursor>();
+  Cursor &c = *cursor_;
+  if (c.initialized)
+    inflateEnd(&c.strm);
+  c.strm = z_stream{};
+  c.initialized =
+      inflateInit2(&c.strm, point.header ? kAutoHeader : kRawDeflate) == Z_OK;
+  if (!c.initialized)
+    return false;
+
+  if (!c.file.is_open())
+    c.file.open(path_, std::ios::binary);
+  c.file.clear();
+  c.file.seekg(static_cast<std::streamoff>(point.in - (point.bits ? 1 : 0)));
+  if (!c.file)
+    return false;
+  if (point.bits) {
+    const int byte = c.file.get();
+    if (byte == EOF)
+      return false;
+    inflatePrime(&c.strm, point.bits, byte >> (8 - point.bits));
+  }
+  if (!point.header)
+    inflateSetDictionary(&c.strm, point.window.data(),
+                         static_cast<uInt>(point.window.size()));
+
+  c.raw = !point.header;
+  c.skip_trailer = 0;
+  c.finished = false;
+  c.out = point.out;
+  c.block_start = (point.out + kBlockSize - 1) / kBlockSize * kBlockSize;
+  c.discard = c.block_start - point.out;
+  c.block.resize(kBlockSize);
+  c.fill = 0;
+  return true;
+}
+
+bool GzipSource::advance_until(size_t index) const {
+  Cursor &c = *cursor_;
+  std::vector<uint8_t> scratch;
+
+  while (!c.finished && blocks_.find(index) == blocks_.end()) {
+    if (c.strm.avail_in == 0) {
+      c.file.read(reinterpret_cast<char *>(c.input.data()),
+                  static_cast<std::streamsize>(c.input.size()));
+      c.strm.avail_in = static_cast<uInt>(c.file.gcount());
+      c.strm.next_in = c.input.data();
+      if (c.strm.avail_in == 0) {
+        c.finished = true;
+        break;
+      }
+    }
+
+    // raw 模式下一个成员结束：跳过尾部后按 gzip 头继续解下一个成员
+    if (c.skip_trailer > 0) {
+      const auto skip = static_cast<uInt>(
+          std::min<size_t>(c.skip_trailer, c.strm.avail_in));
+      c.strm.next_in += skip;
+      c.strm.avail_in -= skip;
+      c.skip_trailer -= skip;
+      if (c.skip_trailer == 0) {
+        inflateReset2(&c.strm, kAutoHeader);
+        c.raw = false;
+      }
+      continue;
+    }
+
+    if (c.discard > 0) {
+      scratch.resize(std::min<size_t>(c.discard, kInputChunk));
+      c.strm.next_out = scratch.data();
+      c.strm.avail_out = static_cast<uInt>(scratch.size());
+    } else {
+      c.strm.next_out = c.block.data() + c.fill;
+      c.strm.avail_out = static_cast<uInt>(kBlockSize - c.fill);
+    }
+    const uInt before = c.strm.avail_out;
+    const int ret = inflate(&c.strm, Z_NO_FLUSH);
+    const size_t produced = before - c.strm.avail_out;
+
+    c.out += produced;
+    if (c.discard > 0) {
+      c.discard -= produced;
+    } else {
+      c.fill += produced;
+      if (c.fill == kBlockSize) {
+        cache_block(c.block_start / kBlockSize, c.block);
+        c.block_start += kBlockSize;
+        c.fill = 0;
+      }
+    }
+
+    if (ret == Z_STREAM_END) {
+      if (c.raw)
+        c.skip_trailer = kGzipTrailer;
+      else
+        inflateReset(&c.strm);
+    } else if (ret != Z_OK && !(ret == Z_BUF_ERROR && produced == 0 &&
+                                c.strm.avail_in == 0)) {
+      c.finished = true;
+    }
+  }
+
+  // 数据结束：缓存最后一个不完整的块
+  if (c.finished && c.discard == 0 && c.fill > 0) {
+    const auto end = c.block.begin() + static_cast<std::ptrdiff_t>(c.fill);
+    cache_block(c.block_start / kBlockSize,
+                std::vector<uint8_t>(c.block.begin(), end));
+    c.fill = 0;
+  }
+  return blocks_.find(index) != blocks_.end();
+}
+
+void GzipSource::cache_block(size_t index, std::vector<uint8_t> bytes) const {
+  auto it = blocks_.find(index);
+  if (it != blocks_.end()) {
+    lru_.erase(it->second);
+    blocks_.erase(it);
+  }
+  if (lru_.size() >= max_blocks_) {
+    blocks_.erase(lru_.back().index);
+    lru_.pop_back();
+  }
+  lru_.push_front(Block{index, std::move(bytes)});
+  blocks_[index] = lru_.begin();
+}
+
+const GzipSource::Block *GzipSource::fetch(size_t index) const {
+  auto it = blocks_.find(index);
+  if (it != blocks_.end()) {
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return &lru_.front();
+  }
+
+  // 游标已在目标之前且不早于最近的检查点时直接向前解压，否则从检查点重来
+  const size_t target = index * kBlockSize;
+  uint64_t nearest = 0;
+  {
+    std::lock_guard<std::mutex> lock(index_mutex_);
+    auto p = std::upper_bound(
+        points_.begin(), points_.end(), target,
+        [](size_t pos, const Checkpoint &cp) { return pos < cp.out; });
+    if (p != points_.begin())
+      nearest = std::prev(p)->out;
+  }
+  const bool reuse = cursor_ && !cursor_->finished &&
+                     cursor_->block_start <= target && cursor_->out >= nearest;
+  if (!reuse && !restart(target))
+    return nullptr;
+  if (!advance_until(index))
+    return nullptr;
+
+  it = blocks_.find(index);
+  lru_.splice(lru_.begin(), lru_, it->second);
+  return &lru_.front();
+}
+
+size_t GzipSource::read(size_t pos, uint8_t *dst, size_t n) const {
+  const size_t total = size();
+  if (pos >= total)
+    return 0;
+  n = std::min(n, total - pos);
+
+  std::lock_guard<std::mutex> lock(reader_mutex_);
+  size_t done = 0;
+  while (done < n) {
+    const size_t at = pos + done;
+    const Block *block = fetch(at / kBlockSize);
+    const size_t in_block = at % kBlockSize;
+    if (!block || in_block >= block->bytes.size())
+      break;
+    const size_t chunk = std::min(n - done, block->bytes.size() - in_block);
+    std::memcpy(dst + done, block->bytes.data() + in_block, chunk);
+    done += chunk;
+  }
+  return done;
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "DataSource.hpp"
+
+// ========== GzipSource ==========
+/// 以解压后的字节流作为数据源的 .gz 文件：首次打开时在后台线程完整解压一遍，
+/// 每隔 span 字节在 deflate 块边界处记录一个检查点（输入/输出偏移 + 32K 窗口），
+/// 索引保存到旁路文件 "<path>.bri" 供下次直接加载。随机读取只需从最近的
+/// 检查点开始解压，解压出的块放入有上限的 LRU 缓存
+class GzipSource : public DataSource {
+public:
+  static constexpr size_t kBlockSize = 64 * 1024;
+  static constexpr size_t kWindowSize = 32 * 1024;
+
+  /// 文件开头是否为 gzip 魔数
+  static bool is_gzip(const std::string &path);
+
+  /// 打开 .gz 文件：旁路索引有效时直接加载，否则在后台建立索引
+  /// （建立过程中 size() 随进度增长，完成后回调 on_progress）
+  static std::unique_ptr<GzipSource> open(const std::string &path,
+                                          size_t span, size_t cache_bytes,
+                                          std::function<void()> on_progress);
+
+  ~GzipSource() override;
+  GzipSource(const GzipSource &) = delete;
+  GzipSource &operator=(const GzipSource &) = delete;
+
+  [[nodiscard]] size_t size() const override {
+    return indexed_.load(std::memory_order_acquire);
+  }
+  size_t read(size_t pos, uint8_t *dst, size_t n) const override;
+  [[nodiscard]] bool loading() const override {
+    return !indexed_all_.load(std::memory_order_acquire);
+  }
+
+  /// 阻塞直到索引建立完成
+  void wait() const;
+
+  /// 检查点数量
+  [[nodiscard]] size_t checkpoints() const;
+
+  /// 索引是否由旁路文件加载
+  [[nodiscard]] bool index_from_sidecar() const { return from_sidecar_; }
+
+  /// 旁路索引文件路径
+  static std::string sidecar_path(const std::string &path) {
+    return path + ".bri";
+  }
+
+private:
+  /// 解压检查点：从 in 处（bits 个位之前）恢复 raw inflate 即可得到 out 处的输出；
+  /// header 为 true 表示该处是一个 gzip 成员的开头
+  struct Checkpoint {
+    uint64_t out = 0;
+    uint64_t in = 0;
+    int bits = 0;
+    bool header = false;
+    std::vector<uint8_t> window;
+  };
+
+  struct Block {
+    size_t index;
+    std::vector<uint8_t> bytes;
+  };
+
+  GzipSource(std::string path, size_t span, size_t cache_bytes,
+             std::function<void()> on_progress);
+
+  void build_index();
+  bool load_sidecar();
+  void save_sidecar() const;
+
+  /// 取得第 index 块（必要时从最近的检查点解压），调用方需持有 reader_mutex_
+  const Block *fetch(size_t index) const;
+  /// 把解压游标定位到 target 之前最近的检查点
+  bool restart(size_t target) const;
+  /// 解压游标向前推进，直到第 index 块进入缓存或数据结束
+  bool advance_until(size_t index) const;
+  void cache_block(size_t index, std::vector<uint8_t> bytes) const;
+
+  std::string path_;
+  size_t span_;
+  size_t max_blocks_;
+  std::function<void()> on_progress_;
+  uint64_t compressed_size_ = 0;
+  int64_t mtime_ = 0;
+  bool from_sidecar_ = false;
+
+  // —— 索引（后台线程追加，读取方加锁访问）—— //
+  mutable std::mutex index_mutex_;
+  mutable std::condition_variable index_cv_;
+  std::vector<Checkpoint> points_;
+  std::atomic<size_t> indexed_{0};
+  std::atomic<bool> indexed_all_{false};
+  std::atomic<bool> stop_{false};
+  std::thread builder_;
+
+  // —— 随机读取的解压游标与块缓存 —— //
+  struct Cursor;
+  mutable std::mutex reader_mutex_;
+  mutable std::unique_ptr<Cursor> cursor_;
+  mutable std::list<Block> lru_;
+  mutable std::unordered_map<size_t, std::list<Block>::iterator> blocks_;
+};
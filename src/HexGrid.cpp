@@ -0,0 +1,239 @@
+#include "HexGrid.hpp"
+#include "ByteClass.hpp"
+
+#include <algorithm>
+#include <array>
+#include <fmt/format.h>
+#include <ftxui/dom/node.hpp>
+#include <ftxui/dom/requirement.hpp>
+#include <ftxui/screen/box.hpp>
+#include <ftxui/screen/color.hpp>
+#include <ftxui/screen/screen.hpp>
+#include <string_view>
+#include <vector>
+
+using namespace ftxui;
+
+namespace {
+constexpr char kAddrDigits[] = "0123456789abcdef";
+
+using ClassColors = std::array<Color, kByteClassCount>;
+/// 按 ByteClass 着色：零、可打印、空白、控制字符、高位字节、0xFF
+const ClassColors kClassColors = {Color::GrayDark, Color::Cyan,
+                                  Color::Green,    Color::Magenta,
+                                  Color::Yellow,   Color::Red};
+/// 关闭着色时：十六进制列默认色，ASCII 列黄色
+const ClassColors kPlainHex = {Color::Default, Color::Default, Color::Default,
+                               Color::Default, Color::Default, Color::Default};
+const ClassColors kPlainAscii = {Color::Yellow, Color::Yellow, Color::Yellow,
+                                 Color::Yellow, Color::Yellow, Color::Yellow};
+
+class HexGridNode : public Node {
+public:
+  HexGridNode(const AppState &state, RowCache &cache)
+      : state_(state), cache_(cache) {}
+
+  void ComputeRequirement() override {
+    plan();
+    const size_t bpl = state_.bytes_per_line;
+    // 地址 + ": " + 每字节 "XX " + "│" + 每字节 1 个 ASCII 字符
+    requirement_.min_x = static_cast<int>(addr_width_ + 2 + 4 * bpl + 1);
+    requirement_.min_y = static_cast<int>(rows_.size());
+  }
+
+  void Render(Screen &screen) override {
+    int y = box_.y_min;
+    for (const Row &row : rows_) {
+      if (y > box_.y_max)
+        break;
+      switch (row.kind) {
+      case Row::Kind::Data:
+        paint_data(screen, y, row.addr);
+        break;
+      case Row::Kind::Hole:
+        paint_hole(screen, y, row);
+        break;
+      case Row::Kind::Separator:
+        paint_separator(screen, y, *row.segment);
+        break;
+      }
+      ++y;
+    }
+  }
+
+private:
+  struct Row {
+    enum class Kind { Data, Hole, Separator };
+    Kind kind = Kind::Data;
+    size_t addr = 0;
+    size_t end = 0;                   // Hole：空洞结束位置
+    const Segment *segment = nullptr; // Separator：新文件段
+  };
+
+  /// 计算当前页每一行显示什么：数据行、折叠的空洞、文件段分隔行
+  void plan() {
+    const size_t bpl = state_.bytes_per_line;
+    const size_t total = state_.data.size();
+    const auto holes = state_.data.extents();
+    const auto *segments = state_.data.segments();
+
+    addr_width_ = state_.address_digits();
+
+    size_t addr = state_.view_start();
+    // 下一个需要画分隔行的文件段（第一个文件段之前不画）
+    size_t next_seg = 0;
+    if (segments) {
+      next_seg = static_cast<size_t>(
+          std::lower_bound(
+              segments->begin(), segments->end(), addr,
+              [](const Segment &seg, size_t a) { return seg.offset < a; }) -
+          segments->begin());
+      next_seg = std::max<size_t>(next_seg, 1);
+    }
+
+    // 行缓存至少能容纳两屏，视口滚动时整屏的行都留在环中
+    cache_.reserve_rows(2 * state_.hex_view_h);
+    rows_.clear();
+    rows_.reserve(state_.hex_view_h);
+    while (rows_.size() < state_.hex_view_h && addr < total) {
+      // 拼接文件的接缝：在包含下一个文件开头的行之前画一行分隔
+      if (segments && next_seg < segments->size() &&
+          (*segments)[next_seg].offset < addr + bpl) {
+        Row row{Row::Kind::Separator, addr, 0, &(*segments)[next_seg++]};
+        rows_.push_back(row);
+        continue;
+      }
+      // 覆盖整行的空洞折叠成一行标记，不读取空洞内容
+      if (holes) {
+        if (auto hole = holes->hole_at(addr);
+            hole && hole->end() >= addr + bpl) {
+          rows_.push_back(Row{Row::Kind::Hole, addr, hole->end(), nullptr});
+          // 从空洞结束所在的行继续
+          addr = hole->end() / bpl * bpl;
+          continue;
+        }
+      }
+      rows_.push_back(Row{Row::Kind::Data, addr, 0, nullptr});
+      addr += bpl;
+    }
+  }
+
+  /// 在 (x, y) 写入一个字符；超出 box_ 的部分被裁剪
+  void put(Screen &screen, int x, int y, char c, Color fg,
+           bool inverted) const {
+    if (x < box_.x_min || x > box_.x_max || y < box_.y_min || y > box_.y_max)
+      return;
+    Pixel &pixel = screen.PixelAt(x, y);
+    pixel.character.assign(1, c);
+    pixel.foreground_color = fg;
+    pixel.inverted = inverted;
+  }
+
+  /// 写入一个多字节字形（如框线字符）
+  void put_glyph(Screen &screen, int x, int y, const char *glyph,
+                 Color fg) const {
+    if (x < box_.x_min || x > box_.x_max || y < box_.y_min || y > box_.y_max)
+      return;
+    Pixel &pixel = screen.PixelAt(x, y);
+    pixel.character = glyph;
+    pixel.foreground_color = fg;
+  }
+
+  /// 写入 ASCII 字符串，返回下一列的位置
+  int put_text(Screen &screen, int x, int y, std::string_view str, Color fg,
+               bool inverted = false) const {
+    for (char c : str)
+      put(screen, x++, y, c, fg, inverted);
+    return x;
+  }
+
+  /// addr_width_ 位小写十六进制地址
+  int put_hex(Screen &screen, int x, int y, size_t addr, Color fg,
+              bool inverted = false) const {
+    for (size_t i = addr_width_; i-- > 0;)
+      put(screen, x++, y, kAddrDigits[(addr >> (4 * i)) & 0xF], fg, inverted);
+    return x;
+  }
+
+  /// 地址列："xxxxxxxx: "
+  int put_addr(Screen &screen, int x, int y, size_t addr, Color fg,
+               bool inverted = false) const {
+    x = put_hex(screen, x, y, addr, fg, inverted);
+    put(screen, x++, y, ':', fg, inverted);
+    put(screen, x++, y, ' ', fg, inverted);
+    return x;
+  }
+
+  void paint_data(Screen &screen, int y, size_t addr) const {
+    const size_t bpl = state_.bytes_per_line;
+    // 格式化结果来自行缓存，这里只负责写像素并叠加光标高亮
+    const FormattedRow &row =
+        cache_.row(state_.data, addr, bpl, render_mode(), addr_width_);
+    const int hex_x = put_text(screen, box_.x_min, y, row.address, Color::Blue);
+    const int bar_x = hex_x + static_cast<int>(3 * bpl);
+    put_glyph(screen, bar_x, y, "│", Color::GrayDark);
+    const int ascii_x = bar_x + 1;
+
+    const bool cursor_row =
+        state_.cursor_pos >= addr && state_.cursor_pos < addr + row.valid;
+    const size_t cursor = cursor_row ? state_.cursor_pos - addr : row.valid;
+    // 颜色直接按行缓存里的字节类别查表
+    const ClassColors &hex_colors = state_.byte_colors ? kClassColors : kPlainHex;
+    const ClassColors &ascii_colors =
+        state_.byte_colors ? kClassColors : kPlainAscii;
+    for (size_t j = 0; j < row.valid; ++j) {
+      const bool active = j == cursor;
+      const int x = hex_x + static_cast<int>(3 * j);
+      const Color fg = hex_colors[row.classes[j]];
+      put(screen, x, y, row.hex[3 * j], fg, active);
+      put(screen, x + 1, y, row.hex[3 * j + 1], fg, active);
+      put(screen, x + 2, y, row.hex[3 * j + 2], fg, active);
+      put(screen, ascii_x + static_cast<int>(j), y, row.ascii[j],
+          ascii_colors[row.classes[j]], active);
+    }
+  }
+
+  /// 影响行内容的显示模式，作为行缓存键的一部分（字节序不影响
+  /// 地址/十六进制/ASCII，不在其中）
+  [[nodiscard]] uint32_t render_mode() const {
+    return state_.byte_colors ? 0u : RowCache::kPlain;
+  }
+
+  void paint_hole(Screen &screen, int y, const Row &row) const {
+    const bool active =
+        state_.cursor_pos >= row.addr && state_.cursor_pos < row.end;
+    int x = put_addr(screen, box_.x_min, y, row.addr, Color::GrayDark, active);
+    std::array<char, 96> text{};
+    const auto out = fmt::format_to_n(
+        text.data(), text.size(), "---- hole: {} bytes, data resumes at {:0{}x} ----",
+        row.end - row.addr, row.end, addr_width_);
+    put_text(screen, x, y,
+             std::string_view(text.data(), std::min(out.size, text.size())),
+             Color::GrayDark, active);
+  }
+
+  void paint_separator(Screen &screen, int y, const Segment &segment) const {
+    int x = box_.x_min;
+    for (int i = 0; i < 4; ++i)
+      put_glyph(screen, x++, y, "─", Color::Cyan);
+    x = put_text(screen, x, y, " ", Color::Cyan);
+    x = put_text(screen, x, y, segment.name, Color::Cyan);
+    x = put_text(screen, x, y, " @ ", Color::Cyan);
+    x = put_hex(screen, x, y, segment.offset, Color::Cyan);
+    x = put_text(screen, x, y, " ", Color::Cyan);
+    for (int i = 0; i < 4; ++i)
+      put_glyph(screen, x++, y, "─", Color::Cyan);
+  }
+
+  const AppState &state_;
+  RowCache &cache_;
+  size_t addr_width_ = 8;
+  std::vector<Row> rows_;
+};
+} // namespace
+
+namespace UIComponents {
+Element HexGrid(const AppState &state, RowCache &cache) {
+  return std::make_shared<HexGridNode>(state, cache);
+}
+} // namespace UIComponents
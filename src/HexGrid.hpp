@@ -0,0 +1,14 @@
+#pragma once
+
+#include <ftxui/dom/elements.hpp>
+
+#include "AppState.hpp"
+#include "RowCache.hpp"
+
+namespace UIComponents {
+/// Hex 网格元素：布局（行类型与位置）在 ComputeRequirement 中计算一次，
+/// Render 时按查表结果把字符与光标高亮直接写入 Screen 像素，
+/// 不为每个字节创建 text() 节点和字符串。数据行的格式化结果取自 cache
+/// （由调用方跨帧持有）
+ftxui::Element HexGrid(const AppState &state, RowCache &cache);
+} // namespace UIComponents
@@ -0,0 +1,51 @@
+#include "InputBatcher.hpp"
+
+namespace {
+/// 方向相反的导航命令
+CommandType opposite(CommandType type) {
+  switch (type) {
+  case CommandType::MoveUp:
+    return CommandType::MoveDown;
+  case CommandType::MoveDown:
+    return CommandType::MoveUp;
+  case CommandType::MoveLeft:
+    return CommandType::MoveRight;
+  case CommandType::MoveRight:
+    return CommandType::MoveLeft;
+  case CommandType::PageUp:
+    return CommandType::PageDown;
+  case CommandType::PageDown:
+    return CommandType::PageUp;
+  case CommandType::ReadByte:
+  case CommandType::None:
+  case CommandType::Jump:
+    break;
+  }
+  return CommandType::None;
+}
+} // namespace
+
+void InputBatcher::push(CommandType type) {
+  if (opposite(type) == CommandType::None)
+    return;
+  if (!runs_.empty()) {
+    Run &last = runs_.back();
+    if (last.type == type) {
+      ++last.count;
+      return;
+    }
+    // 光标在边界被截住时抵消并不完全等价，但按住方向键来回切换时足够
+    if (last.type == opposite(type)) {
+      if (--last.count == 0)
+        runs_.pop_back();
+      return;
+    }
+  }
+  runs_.push_back(Run{type, 1});
+}
+
+std::vector<InputBatcher::Run> InputBatcher::take() {
+  std::vector<Run> runs;
+  runs.swap(runs_);
+  return runs;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <vector>
+
+#include "Command.hpp"
+
+// ========== InputBatcher ==========
+/// 合并两帧之间到达的导航命令：相邻的同类命令合并计数，方向相反的命令
+/// 互相抵消，绘制前按段整体执行（连按 37 次向下只移动一次光标）。
+/// 终端事件循环在绘制之前处理完所有排队的事件，因此在绘制时取出批次，
+/// 每帧正好执行一次，不需要另外计时
+class InputBatcher {
+public:
+  /// 连续同类命令合并后的一段
+  struct Run {
+    CommandType type = CommandType::None;
+    size_t count = 0;
+  };
+
+  /// 追加一条导航命令（非导航命令被忽略）
+  void push(CommandType type);
+
+  /// 取出并清空累计的命令
+  std::vector<Run> take();
+
+  [[nodiscard]] bool empty() const { return runs_.empty(); }
+
+private:
+  std::vector<Run> runs_;
+};
@@ -0,0 +1,101 @@
+#include "PerfHud.hpp"
+
+#include <fmt/format.h>
+#include <ftxui/dom/node.hpp>
+#include <ftxui/screen/box.hpp>
+#include <ftxui/screen/screen.hpp>
+
+using namespace ftxui;
+
+namespace {
+/// 对子元素的 ComputeRequirement / SetBox / Render 计时，
+/// 并把面板搭建的元素数计入 section
+class TimedNode : public Node {
+public:
+  TimedNode(FrameSection section, Element child, size_t elements)
+      : Node(Elements{std::move(child)}), section_(section) {
+    FrameStats::instance().add_elements(section_, elements);
+  }
+
+  void ComputeRequirement() override {
+    FrameStats::Scope scope(section_);
+    children_[0]->ComputeRequirement();
+    requirement_ = children_[0]->requirement();
+  }
+
+  void SetBox(Box box) override {
+    FrameStats::Scope scope(section_);
+    Node::SetBox(box);
+    children_[0]->SetBox(box);
+  }
+
+  void Render(Screen &screen) override {
+    FrameStats::Scope scope(section_);
+    children_[0]->Render(screen);
+  }
+
+private:
+  FrameSection section_;
+};
+
+/// 子元素绘制完后结束本帧
+class FrameEndNode : public Node {
+public:
+  explicit FrameEndNode(Element child) : Node(Elements{std::move(child)}) {}
+
+  void ComputeRequirement() override {
+    children_[0]->ComputeRequirement();
+    requirement_ = children_[0]->requirement();
+  }
+
+  void SetBox(Box box) override {
+    Node::SetBox(box);
+    children_[0]->SetBox(box);
+  }
+
+  void Render(Screen &screen) override {
+    children_[0]->Render(screen);
+    FrameStats::instance().end_frame();
+  }
+};
+} // namespace
+
+namespace UIComponents {
+Element Timed(FrameSection section, Element element, size_t elements) {
+  if (!FrameStats::instance().enabled())
+    return element;
+  return std::make_shared<TimedNode>(section, std::move(element), elements);
+}
+
+Element FrameEnd(Element element) {
+  if (!FrameStats::instance().enabled())
+    return element;
+  return std::make_shared<FrameEndNode>(std::move(element));
+}
+
+Element PerfHud() {
+  const FrameStats &stats = FrameStats::instance();
+  const FrameStats::Frame &last = stats.last();
+  Elements lines;
+  lines.push_back(text(fmt::format("frame p50 {:6.2f}ms p99 {:6.2f}ms",
+                                   stats.percentile(50), stats.percentile(99))));
+  lines.push_back(text(
+      FrameStats::counts_allocations()
+          ? fmt::format("last  {:6.2f}ms  allocs {:>6}", last.total_ms,
+                        last.allocations)
+          : fmt::format("last  {:6.2f}ms  allocs    n/a", last.total_ms)));
+  for (size_t s = 0; s < kFrameSectionCount; ++s) {
+    const auto section = static_cast<FrameSection>(s);
+    lines.push_back(
+        text(fmt::format("{:<8}{:6.2f}ms  el {:>5}",
+                         FrameStats::section_name(section), last.ms[s],
+                         last.elements[s])) |
+        dim);
+  }
+  lines.push_back(text(fmt::format("{} frames, 'perf dump' to save",
+                                   stats.frames())) |
+                  dim);
+  return vbox(std::move(lines)) | border | bgcolor(Color::Black) |
+         color(Color::White);
+}
+} // namespace UIComponents
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <ftxui/dom/elements.hpp>
+
+#include "FrameStats.hpp"
+
+namespace UIComponents {
+/// 把 element 的布局与绘制时间计入 section，并记下面板搭建的元素数
+/// elements（调用方按搭建时的 Elements 数出，如每行一个）；统计关闭时
+/// 原样返回 element
+ftxui::Element Timed(FrameSection section, ftxui::Element element,
+                     size_t elements = 1);
+
+/// 包住整帧的根元素：绘制完成后结束本帧统计
+ftxui::Element FrameEnd(ftxui::Element element);
+
+/// 渲染统计浮层：p50/p99 帧时间、上一帧的分配次数与各面板耗时
+ftxui::Element PerfHud();
+} // namespace UIComponents
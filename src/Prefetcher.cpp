@@ -0,0 +1,71 @@
+#include "Prefetcher.hpp"
+
+#include <algorithm>
+
+std::optional<Extent> Prefetcher::observe(CommandType type, size_t page_start,
+                                          size_t page_bytes, size_t total,
+                                          Clock::time_point now) {
+  int direction = 0;
+  bool page_move = false;
+  switch (type) {
+  case CommandType::PageDown:
+    page_move = true;
+    [[fallthrough]];
+  case CommandType::MoveDown:
+  case CommandType::MoveRight:
+    direction = 1;
+    break;
+  case CommandType::PageUp:
+    page_move = true;
+    [[fallthrough]];
+  case CommandType::MoveUp:
+  case CommandType::MoveLeft:
+    direction = -1;
+    break;
+  case CommandType::ReadByte:
+  case CommandType::None:
+  case CommandType::Jump:
+    break;
+  }
+  if (direction == 0 || page_bytes == 0 || total == 0)
+    return std::nullopt;
+
+  // 同方向连续翻页时加深预读；行/字节移动只需要保证下一页就绪
+  const bool burst = direction == direction_ && now - last_ < kBurstGap;
+  if (!burst) {
+    depth_ = 1;
+    window_ = Extent{};
+  } else if (page_move) {
+    depth_ = std::min(depth_ + 1, kMaxPages);
+  }
+  direction_ = direction;
+  last_ = now;
+
+  const size_t span = depth_ * page_bytes;
+  size_t begin = 0;
+  size_t end = 0;
+  if (direction > 0) {
+    begin = std::min(page_start + page_bytes, total);
+    end = std::min(begin + std::min(span, total - begin), total);
+    // 跳过已经预读过的部分
+    if (begin < window_.end() && window_.offset <= begin)
+      begin = std::min(window_.end(), end);
+  } else {
+    end = std::min(page_start, total);
+    begin = end - std::min(span, end);
+    if (end > window_.offset && window_.end() >= end)
+      end = std::max(window_.offset, begin);
+  }
+  if (begin >= end)
+    return std::nullopt;
+
+  // 记录累计覆盖的范围（同一方向上连续）
+  if (window_.length == 0) {
+    window_ = Extent{begin, end - begin};
+  } else {
+    const size_t lo = std::min(window_.offset, begin);
+    const size_t hi = std::max(window_.end(), end);
+    window_ = Extent{lo, hi - lo};
+  }
+  return Extent{begin, end - begin};
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <optional>
+
+#include "Command.hpp"
+#include "DataSource.hpp"
+
+// ========== Prefetcher ==========
+/// 根据导航命令的方向与速度估计接下来要看的区域：同方向的命令连续到达时
+/// 预读深度逐渐加大（最多 kMaxPages 页），换向或停顿后重新开始。
+/// 只负责计算范围，实际的预读由 DataSource::advise 异步完成
+class Prefetcher {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  static constexpr size_t kMaxPages = 8;
+  /// 两次命令间隔小于该值视为连续滚动（按住按键时的自动重复）
+  static constexpr Clock::duration kBurstGap = std::chrono::milliseconds(300);
+
+  /// 记录一次命令；page_start 为命令执行后当前页的起始偏移，page_bytes 为
+  /// 一页的字节数。返回尚未预读过的范围，没有需要预读的内容时返回空
+  std::optional<Extent> observe(CommandType type, size_t page_start,
+                                size_t page_bytes, size_t total,
+                                Clock::time_point now = Clock::now());
+
+  /// 当前预读深度（页数）
+  [[nodiscard]] size_t depth() const { return depth_; }
+
+  /// 清空状态（打开新文件时调用）
+  void reset() { *this = Prefetcher(); }
+
+private:
+  int direction_ = 0; // 1 向后，-1 向前，0 尚未滚动
+  size_t depth_ = 0;
+  Clock::time_point last_{};
+  Extent window_{}; // 最近一次已预读的范围
+};
@@ -0,0 +1,141 @@
+#include "ProcMemSource.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fmt/format.h>
+#include <fstream>
+#include <sstream>
+#include <string_view>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+/// 超过该地址的映射（如 [vsyscall]）不可通过 /proc/pid/mem 读取，忽略
+constexpr size_t kUserSpaceEnd = size_t{1} << 57;
+} // namespace
+
+std::optional<int> ProcMemSource::parse_pid(const std::string &path) {
+  constexpr std::string_view kPrefix = "pid:";
+  if (path.size() <= kPrefix.size() || path.compare(0, kPrefix.size(), kPrefix))
+    return std::nullopt;
+  int pid = 0;
+  for (size_t i = kPrefix.size(); i < path.size(); ++i) {
+    if (path[i] < '0' || path[i] > '9' || pid > 100000000)
+      return std::nullopt;
+    pid = pid * 10 + (path[i] - '0');
+  }
+  return pid > 0 ? std::optional<int>(pid) : std::nullopt;
+}
+
+std::unique_ptr<ProcMemSource> ProcMemSource::open(int pid) {
+#ifdef __linux__
+  const std::string mem = fmt::format("/proc/{}/mem", pid);
+  const int fd = ::open(mem.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    return nullptr;
+  std::unique_ptr<ProcMemSource> source(new ProcMemSource(pid, fd));
+  if (!source->load_maps())
+    return nullptr;
+  return source;
+#else
+  (void)pid;
+  errno = ENOTSUP;
+  return nullptr;
+#endif
+}
+
+ProcMemSource::~ProcMemSource() {
+#ifdef __linux__
+  if (fd_ >= 0)
+    ::close(fd_);
+#endif
+}
+
+bool ProcMemSource::load_maps() {
+  std::ifstream maps(fmt::format("/proc/{}/maps", pid_));
+  if (!maps)
+    return false;
+
+  std::vector<Extent> readable;
+  std::string line;
+  while (std::getline(maps, line)) {
+    // 格式：start-end perms offset dev inode [pathname]
+    std::istringstream fields(line);
+    std::string range, perms, offset, dev, inode, pathname;
+    fields >> range >> perms >> offset >> dev >> inode;
+    std::getline(fields >> std::ws, pathname);
+
+    const auto dash = range.find('-');
+    if (dash == std::string::npos || perms.size() < 4)
+      continue;
+    const size_t start = std::stoull(range.substr(0, dash), nullptr, 16);
+    const size_t end = std::stoull(range.substr(dash + 1), nullptr, 16);
+    if (end <= start || end > kUserSpaceEnd)
+      continue;
+
+    const std::string name =
+        pathname.empty()
+            ? "[anon]"
+            : std::filesystem::path(pathname).filename().string();
+    regions_.push_back(Segment{start, end - start, name + " " + perms});
+    if (perms[0] == 'r')
+      readable.push_back(Extent{start, end - start});
+    size_ = std::max(size_, end);
+  }
+  extents_ = std::make_shared<const ExtentMap>(std::move(readable), size_);
+  return true;
+}
+
+const ProcMemSource::Page &ProcMemSource::fetch(size_t index) const {
+  const auto now = Clock::now();
+  if (auto it = pages_.find(index); it != pages_.end()) {
+    lru_.splice(lru_.begin(), lru_, it->second);
+    if (now - it->second->fetched < kPageTtl)
+      return *it->second;
+    lru_.erase(it->second);
+    pages_.erase(it);
+  }
+
+  Page page{index, now, std::vector<uint8_t>(kPageSize, 0)};
+  // 只读取落在可读区域中的页；未映射或不可读的页保持为 0
+  if (!extents_->hole_at(index * kPageSize)) {
+#ifdef __linux__
+    const ssize_t got = ::pread(fd_, page.bytes.data(), kPageSize,
+                                static_cast<off_t>(index * kPageSize));
+    if (got < 0)
+      std::fill(page.bytes.begin(), page.bytes.end(), 0);
+#endif
+  }
+
+  lru_.push_front(std::move(page));
+  pages_[index] = lru_.begin();
+  while (lru_.size() > kMaxPages) {
+    pages_.erase(lru_.back().index);
+    lru_.pop_back();
+  }
+  return lru_.front();
+}
+
+size_t ProcMemSource::read(size_t pos, uint8_t *dst, size_t n) const {
+  if (pos >= size_)
+    return 0;
+  n = std::min(n, size_ - pos);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t done = 0;
+  while (done < n) {
+    const size_t at = pos + done;
+    const Page &page = fetch(at / kPageSize);
+    const size_t in_page = at % kPageSize;
+    const size_t chunk = std::min(n - done, kPageSize - in_page);
+    std::memcpy(dst + done, page.bytes.data() + in_page, chunk);
+    done += chunk;
+  }
+  return done;
+}
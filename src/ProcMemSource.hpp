@@ -0,0 +1,76 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "DataSource.hpp"
+
+// ========== ProcMemSource ==========
+/// 只读查看运行中进程的内存（"pid:1234"，仅 Linux）：偏移即进程的虚拟地址，
+/// 打开时从 /proc/<pid>/maps 读取映射区域（作为数据区段与命名区段，区域之间
+/// 为空洞），读取时按页从 /proc/<pid>/mem 按需 pread，不转储整个进程。
+/// 页缓存很短时间后过期，界面看到的始终是接近实时的内容
+class ProcMemSource : public DataSource {
+public:
+  static constexpr size_t kPageSize = 4096;
+  static constexpr size_t kMaxPages = 256;
+  /// 缓存页的有效期：同一帧内多次访问只读一次
+  static constexpr std::chrono::milliseconds kPageTtl{100};
+
+  /// 解析 "pid:<N>"，不是这种形式时返回空
+  static std::optional<int> parse_pid(const std::string &path);
+
+  /// 打开进程 pid 的内存；进程不存在或没有权限（需要 ptrace 权限）时
+  /// 返回 nullptr，errno 保留失败原因
+  static std::unique_ptr<ProcMemSource> open(int pid);
+
+  ~ProcMemSource() override;
+  ProcMemSource(const ProcMemSource &) = delete;
+  ProcMemSource &operator=(const ProcMemSource &) = delete;
+
+  [[nodiscard]] size_t size() const override { return size_; }
+  size_t read(size_t pos, uint8_t *dst, size_t n) const override;
+  [[nodiscard]] std::shared_ptr<const ExtentMap> extents() const override {
+    return extents_;
+  }
+  /// 进程仍在运行，内存随时可能被改写
+  [[nodiscard]] bool live() const override { return true; }
+  /// 映射区域（打开时的快照），名称为 "路径 权限"
+  [[nodiscard]] const std::vector<Segment> *segments() const override {
+    return &regions_;
+  }
+
+  [[nodiscard]] int pid() const { return pid_; }
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Page {
+    size_t index;
+    Clock::time_point fetched;
+    std::vector<uint8_t> bytes; // 不可读的页全为 0
+  };
+
+  ProcMemSource(int pid, int fd) : pid_(pid), fd_(fd) {}
+
+  bool load_maps();
+  /// 取得第 index 页（过期或不在缓存中时重新读取），调用方需持有锁
+  const Page &fetch(size_t index) const;
+
+  int pid_ = 0;
+  int fd_ = -1;
+  size_t size_ = 0;
+  std::vector<Segment> regions_;
+  std::shared_ptr<const ExtentMap> extents_; // 可读的映射区域
+
+  mutable std::mutex mutex_;
+  mutable std::list<Page> lru_; // 头部为最近使用
+  mutable std::unordered_map<size_t, std::list<Page>::iterator> pages_;
+};
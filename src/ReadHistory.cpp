@@ -0,0 +1,248 @@
+#include "ReadHistory.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <limits>
+
+#include "Utils.hpp"
+
+namespace {
+constexpr const char *kScalarNames[ReadHistory::kScalarKinds] = {
+    "u8", "i8", "u16", "i16", "u32", "i32", "u64", "i64", "f32", "f64"};
+
+template <typename T> T load(const void *src) {
+  T value;
+  std::memcpy(&value, src, sizeof(T));
+  return value;
+}
+
+/// 按种类把 src 处的一个标量格式化
+std::string format_scalar(ReadHistory::Kind kind, const void *src) {
+  using Kind = ReadHistory::Kind;
+  switch (kind) {
+  case Kind::U8: return Utils::format_value(load<uint8_t>(src));
+  case Kind::I8: return Utils::format_value(load<int8_t>(src));
+  case Kind::U16: return Utils::format_value(load<uint16_t>(src));
+  case Kind::I16: return Utils::format_value(load<int16_t>(src));
+  case Kind::U32: return Utils::format_value(load<uint32_t>(src));
+  case Kind::I32: return Utils::format_value(load<int32_t>(src));
+  case Kind::U64: return Utils::format_value(load<uint64_t>(src));
+  case Kind::I64: return Utils::format_value(load<int64_t>(src));
+  case Kind::F32: return Utils::format_value(load<float>(src));
+  case Kind::F64: return Utils::format_value(load<double>(src));
+  default: return "?";
+  }
+}
+
+size_t scalar_size(ReadHistory::Kind kind) {
+  static constexpr size_t kSizes[ReadHistory::kScalarKinds] = {1, 1, 2, 2, 4,
+                                                               4, 8, 8, 4, 8};
+  return kSizes[static_cast<size_t>(kind)];
+}
+} // namespace
+
+ReadHistory::ReadHistory() {
+  // 标量类型的编号与 Kind 相同，push<T> 不需要查表
+  for (size_t k = 0; k < kScalarKinds; ++k)
+    intern(kScalarNames[k], static_cast<Kind>(k));
+}
+
+uint16_t ReadHistory::intern(const std::string &name, Kind kind, Kind elem) {
+  // 同名的 Chars 与 Text（如 "char[5]"）是不同的类型
+  std::string key = name;
+  key += static_cast<char>(kind);
+  if (auto it = type_ids_.find(key); it != type_ids_.end())
+    return it->second;
+  if (types_.size() > std::numeric_limits<uint16_t>::max())
+    throw std::length_error("too many history types");
+  const auto id = static_cast<uint16_t>(types_.size());
+  types_.push_back(Type{name, kind, elem});
+  type_ids_.emplace(std::move(key), id);
+  return id;
+}
+
+void ReadHistory::append(size_t offset, uint16_t type, size_t length,
+                         uint64_t value) {
+  if (length > std::numeric_limits<uint32_t>::max())
+    throw std::length_error("history record too long");
+  if (offsets_.size() >= kNone)
+    throw std::length_error("history log too long");
+  const auto j = static_cast<uint32_t>(offsets_.size());
+  const uint32_t parent = path_.empty() ? kNone : path_.back();
+  offsets_.push_back(offset);
+  types_col_.push_back(type);
+  lengths_.push_back(static_cast<uint32_t>(length));
+  values_.push_back(value);
+  parent_.push_back(parent);
+  path_.push_back(j);
+  // 撤销掉的记录留在日志中，作为兄弟分支
+  future_.clear();
+}
+
+void ReadHistory::push_blob(size_t offset, uint16_t type, const void *data,
+                            size_t length) {
+  const size_t at = blob_.size();
+  append(offset, type, length, at);
+  blob_.append(static_cast<const char *>(data), length);
+}
+
+void ReadHistory::push_chars(size_t offset, uint16_t type, ByteSpan text) {
+  append(offset, type, text.length, text.offset);
+}
+
+void ReadHistory::push_text(size_t offset, uint16_t type, ByteSpan text,
+                            const DataBuffer &data) {
+  // 字节区中先放 8 字节的数据偏移（供 span / end_of），再放预览；
+  // 预览长度由记录长度推出，数据已变短时补 0
+  std::string preview = ReadHistory::text(data, text, kPreviewChars);
+  preview.resize(std::min(text.length, kPreviewChars));
+  const size_t at = blob_.size();
+  const uint64_t where = text.offset;
+  append(offset, type, text.length, at);
+  blob_.append(reinterpret_cast<const char *>(&where), sizeof(where));
+  blob_ += preview;
+}
+
+std::string_view ReadHistory::bytes(size_t i) const {
+  const uint32_t j = path_[i];
+  if (types_[types_col_[j]].kind == Kind::Text)
+    return std::string_view(blob_).substr(
+        values_[j] + sizeof(uint64_t),
+        std::min<size_t>(lengths_[j], kPreviewChars));
+  return std::string_view(blob_).substr(values_[j], lengths_[j]);
+}
+
+ByteSpan ReadHistory::span(size_t i) const {
+  const uint32_t j = path_[i];
+  uint64_t where = values_[j];
+  if (types_[types_col_[j]].kind == Kind::Text)
+    std::memcpy(&where, blob_.data() + values_[j], sizeof(where));
+  return ByteSpan{static_cast<size_t>(where), lengths_[j]};
+}
+
+bool ReadHistory::undo() {
+  if (path_.empty())
+    return false;
+  future_.push_back(path_.back());
+  path_.pop_back();
+  return true;
+}
+
+bool ReadHistory::redo() {
+  if (future_.empty())
+    return false;
+  path_.push_back(future_.back());
+  future_.pop_back();
+  return true;
+}
+
+std::vector<uint32_t> ReadHistory::children_of_head() const {
+  const uint32_t head = path_.empty() ? kNone : path_.back();
+  // 子记录总在父记录之后追加
+  std::vector<uint32_t> children;
+  for (size_t j = head == kNone ? 0 : head + size_t{1}; j < parent_.size();
+       ++j)
+    if (parent_[j] == head)
+      children.push_back(static_cast<uint32_t>(j));
+  return children;
+}
+
+size_t ReadHistory::switch_branch() {
+  const std::vector<uint32_t> children = children_of_head();
+  if (children.size() < 2)
+    return children.size();
+  // 当前目标的前一个（更早的）兄弟，最早的之后回到最新的
+  const uint32_t target = future_.empty() ? kNone : future_.back();
+  auto it = std::lower_bound(children.begin(), children.end(), target);
+  const uint32_t next =
+      it == children.begin() || it == children.end() ? children.back()
+                                                     : *std::prev(it);
+
+  // 沿 next 的分支每层取最新的子记录：顺序扫描时，父记录在链上的记录
+  // 截断链的后半段并接上自己（下标越大越新）
+  std::vector<uint32_t> chain{next};
+  for (size_t j = next + size_t{1}; j < parent_.size(); ++j) {
+    auto at = std::lower_bound(chain.begin(), chain.end(), parent_[j]);
+    if (at != chain.end() && *at == parent_[j]) {
+      chain.erase(std::next(at), chain.end());
+      chain.push_back(static_cast<uint32_t>(j));
+    }
+  }
+  future_.assign(chain.rbegin(), chain.rend());
+  return children.size();
+}
+
+size_t ReadHistory::branch_count() const { return children_of_head().size(); }
+
+size_t ReadHistory::end_of(size_t i) const {
+  const uint32_t j = path_[i];
+  const Kind kind = types_[types_col_[j]].kind;
+  if (kind == Kind::Chars || kind == Kind::Text)
+    return span(i).offset + lengths_[j];
+  return static_cast<size_t>(offsets_[j]) + lengths_[j];
+}
+
+void ReadHistory::clear() {
+  offsets_.clear();
+  types_col_.clear();
+  lengths_.clear();
+  values_.clear();
+  parent_.clear();
+  blob_.clear();
+  path_.clear();
+  future_.clear();
+}
+
+std::string ReadHistory::text(const DataBuffer &data, ByteSpan span,
+                              size_t max_chars) {
+  std::string out(std::min(span.length, max_chars), '\0');
+  out.resize(data.read(span.offset, reinterpret_cast<uint8_t *>(out.data()),
+                       out.size()));
+  return out;
+}
+
+std::string ReadHistory::format(size_t i, const DataBuffer &data,
+                                size_t max_chars) const {
+  const uint32_t j = path_[i];
+  const Type &t = types_[types_col_[j]];
+  switch (t.kind) {
+  case Kind::Chars: {
+    // 只读取要显示的部分
+    std::string out = text(data, span(i), max_chars);
+    if (lengths_[j] > max_chars)
+      out += "…";
+    return out;
+  }
+  case Kind::Text: {
+    // 只保存了预览：超出预览的部分同样以 "…" 表示
+    std::string out(bytes(i).substr(0, max_chars));
+    if (lengths_[j] > out.size())
+      out += "…";
+    return out;
+  }
+  case Kind::Array: {
+    // 只格式化前 Utils::kArrayPreview 个元素
+    const std::string_view raw = bytes(i);
+    const size_t width = scalar_size(t.elem);
+    const size_t count = raw.size() / width;
+    const size_t shown = std::min(count, Utils::kArrayPreview);
+    std::string out = "[";
+    for (size_t k = 0; k < shown; ++k) {
+      if (k > 0)
+        out += ", ";
+      out += format_scalar(t.elem, raw.data() + k * width);
+    }
+    if (shown < count)
+      out += fmt::format(", … ({} total)", count);
+    return out + "]";
+  }
+  default:
+    return format_scalar(t.kind, &values_[j]);
+  }
+}
+
+std::string ReadHistory::description(size_t i, const DataBuffer &data) const {
+  return fmt::format("{:08x}:{}:{}", offsets_[path_[i]], type_name(i),
+                     format(i, data));
+}
@@ -0,0 +1,207 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+#include "DataSource.hpp"
+
+/// 数据中的一段字节：内容不变的数据源上，字符串记录只保存位置，
+/// 显示时才从数据源读取
+struct ByteSpan {
+  size_t offset = 0;
+  size_t length = 0;
+};
+
+// ========== ReadHistory ==========
+/// 读取历史，按列存放：每条记录有起始偏移(8)、类型编号(2)、字节长度(4)、
+/// 一个 8 字节的值和父记录(4)，共 26 字节；当前分支与 redo 栈上的记录
+/// 另占 4 字节下标。标量直接把解码后的值放在 8 字节里；字符串只记位置，
+/// 8 字节存其内容在数据中的偏移（显示时按需读取可见的部分）。内容可能变化
+/// 的数据源（见 DataSource::immutable）上另把开头至多 kPreviewChars 个字节
+/// 连同数据偏移拷入追加式的字节区（Text），历史显示的是当时读到的内容，
+/// 而拷贝量与字符串长度无关；数组是已按字节序解码的值，整段拷入字节区。
+/// 后两者的 8 字节存字节区中的偏移。类型名称
+/// （"u32"、"u32[3]"、"char[5]"、"string@u16" 等）在类型表中只保存一次，
+/// 格式化时按类型表中的 Kind 分派。
+///
+/// 记录只追加不删除，组成一棵树：每条记录只保存父记录（读取它之前的
+/// head）。当前分支（根→head）保存在 path_，撤销掉的记录压入 future_，
+/// undo/redo 只在两个栈之间移动一个下标，都是 O(1)；undo 之后再读取会
+/// 开出新的分支，旧分支仍留在日志中。子记录与兄弟分支不单独存放，
+/// 只在 switch_branch / branch_count 时扫描父记录列推出。
+/// size() / operator[] 按当前分支编号（最早→最晚），访问不需要拷贝
+class ReadHistory {
+public:
+  /// 值的种类；前 10 个标量的编号同时是它们在类型表中的编号
+  enum class Kind : uint8_t {
+    U8, I8, U16, I16, U32, I32, U64, I64, F32, F64,
+    Chars, // 字符串（引用数据中的字节）
+    Array, // 标量数组（元素种类见 Type::elem）
+    Text,  // 字符串（开头的预览已拷入字节区）
+  };
+  static constexpr size_t kScalarKinds = 10;
+
+  struct Type {
+    std::string name;
+    Kind kind = Kind::U8;
+    Kind elem = Kind::U8; // 数组的元素种类
+  };
+
+  /// 一条记录（按值返回的视图）
+  struct Entry {
+    size_t index = 0;    // 读取起始位置
+    uint16_t type = 0;   // 类型表中的编号
+    uint32_t length = 0; // 读取的字节数
+    uint64_t value = 0;  // 标量的值，或字节区中的偏移
+  };
+
+  ReadHistory();
+
+  /// 标量 T 对应的 Kind
+  template <typename T> static constexpr Kind kind_of() {
+    if constexpr (std::is_same_v<T, uint8_t>) return Kind::U8;
+    else if constexpr (std::is_same_v<T, int8_t>) return Kind::I8;
+    else if constexpr (std::is_same_v<T, uint16_t>) return Kind::U16;
+    else if constexpr (std::is_same_v<T, int16_t>) return Kind::I16;
+    else if constexpr (std::is_same_v<T, uint32_t>) return Kind::U32;
+    else if constexpr (std::is_same_v<T, int32_t>) return Kind::I32;
+    else if constexpr (std::is_same_v<T, uint64_t>) return Kind::U64;
+    else if constexpr (std::is_same_v<T, int64_t>) return Kind::I64;
+    else if constexpr (std::is_same_v<T, float>) return Kind::F32;
+    else {
+      static_assert(std::is_same_v<T, double>, "unsupported history type");
+      return Kind::F64;
+    }
+  }
+
+  /// 取得（必要时登记）名为 name、种类为 kind 的类型编号
+  uint16_t intern(const std::string &name, Kind kind, Kind elem = Kind::U8);
+
+  /// 追加一个标量
+  template <typename T> void push(size_t offset, T value) {
+    uint64_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(T));
+    append(offset, static_cast<uint16_t>(kind_of<T>()), sizeof(T), bits);
+  }
+
+  /// 追加一个字符串：offset 为读取起始位置，text 为内容在数据中的位置，
+  /// type 为 intern 得到的编号
+  void push_chars(size_t offset, uint16_t type, ByteSpan text);
+
+  /// 追加一个带预览的字符串（type 的种类为 Text）：从 data 拷贝 text 开头
+  /// 至多 kPreviewChars 个字节，之后数据再变也不影响这条记录的显示
+  void push_text(size_t offset, uint16_t type, ByteSpan text,
+                 const DataBuffer &data);
+
+  /// 追加 count 个 T 组成的数组（类型名为 "<short>[count]"）
+  template <typename T>
+  void push_array(size_t offset, const T *values, size_t count) {
+    const Kind elem = kind_of<T>();
+    const uint16_t type = intern(
+        std::string(types_[static_cast<size_t>(elem)].name) + "[" +
+            std::to_string(count) + "]",
+        Kind::Array, elem);
+    push_blob(offset, type, values, count * sizeof(T));
+  }
+
+  /// head 移到父记录；已在根时返回 false
+  bool undo();
+  /// head 移到 redo 目标（最近撤销或 switch_branch 选中的子记录）；
+  /// 没有可 redo 的记录时返回 false
+  bool redo();
+  /// 把 redo 目标换成下一个（更早的）兄弟分支，循环；之后的 redo 沿该分支
+  /// 每层最新的子记录前进。返回分支总数（扫描日志，O(日志长度)）
+  size_t switch_branch();
+  /// head 可 redo 的分支数（扫描日志，O(日志长度)）
+  [[nodiscard]] size_t branch_count() const;
+
+  void clear();
+
+  // —— 当前分支（根→head） —— //
+  [[nodiscard]] size_t size() const { return path_.size(); }
+  [[nodiscard]] bool empty() const { return path_.empty(); }
+  [[nodiscard]] Entry operator[](size_t i) const { return log_entry(path_[i]); }
+  [[nodiscard]] Entry back() const { return (*this)[size() - 1]; }
+
+  // —— 整个日志（按追加顺序，包括其他分支） —— //
+  [[nodiscard]] size_t log_size() const { return offsets_.size(); }
+  [[nodiscard]] Entry log_entry(size_t j) const {
+    return Entry{static_cast<size_t>(offsets_[j]), types_col_[j], lengths_[j],
+                 values_[j]};
+  }
+  /// 日志中第 j 条的父记录（kNone 表示根）
+  [[nodiscard]] uint32_t log_parent(size_t j) const { return parent_[j]; }
+
+  static constexpr uint32_t kNone = UINT32_MAX;
+
+  [[nodiscard]] const Type &type(uint16_t id) const { return types_[id]; }
+  [[nodiscard]] size_t type_count() const { return types_.size(); }
+  [[nodiscard]] const std::string &type_name(size_t i) const {
+    return types_[types_col_[path_[i]]].name;
+  }
+
+  /// 第 i 条记录的标量值（类型必须与记录一致）
+  template <typename T> [[nodiscard]] T value(size_t i) const {
+    const uint32_t j = path_[i];
+    if (types_col_[j] != static_cast<uint16_t>(kind_of<T>()))
+      throw std::bad_cast();
+    T out;
+    std::memcpy(&out, &values_[j], sizeof(T));
+    return out;
+  }
+
+  /// 第 i 条数组记录在字节区中的内容，或 Text 记录保存的预览
+  [[nodiscard]] std::string_view bytes(size_t i) const;
+
+  /// 第 i 条字符串记录的内容在数据中的位置
+  [[nodiscard]] ByteSpan span(size_t i) const;
+
+  /// 第 i 条记录读完之后的位置（redo 时光标回到这里）
+  [[nodiscard]] size_t end_of(size_t i) const;
+
+  /// 第 i 条记录的值格式化为文本；字符串最多取 max_chars 个字节（截断时
+  /// 末尾加 "…"），只记了位置的从 data 读取
+  [[nodiscard]] std::string format(size_t i, const DataBuffer &data,
+                                   size_t max_chars = kPreviewChars) const;
+
+  /// 格式化成 “<8 位十六进制地址>:<类型名>:<数据>”
+  [[nodiscard]] std::string description(size_t i,
+                                        const DataBuffer &data) const;
+
+  /// 从 data 中取出 span 的前 max_chars 个字节（数据已变短时只取存在的部分）
+  static std::string text(const DataBuffer &data, ByteSpan span,
+                          size_t max_chars = SIZE_MAX);
+
+  /// 默认预览的字符数
+  static constexpr size_t kPreviewChars = 64;
+
+private:
+  void append(size_t offset, uint16_t type, size_t length, uint64_t value);
+  void push_blob(size_t offset, uint16_t type, const void *data,
+                 size_t length);
+
+  std::vector<Type> types_;
+  std::unordered_map<std::string, uint16_t> type_ids_;
+
+  // —— 按列存放的记录（只追加） —— //
+  std::vector<uint64_t> offsets_;
+  std::vector<uint16_t> types_col_;
+  std::vector<uint32_t> lengths_;
+  std::vector<uint64_t> values_;
+  std::vector<uint32_t> parent_; // 父记录（kNone 表示根）
+  std::string blob_; // 数组的内容与 Text 的预览，按记录顺序追加
+
+  // —— 树结构 —— //
+  std::vector<uint32_t> path_;   // 当前分支各记录的日志下标，末尾即 head
+  std::vector<uint32_t> future_; // redo 栈，末尾为下一个 redo 的记录
+
+  /// head 的各子记录（日志下标升序）
+  [[nodiscard]] std::vector<uint32_t> children_of_head() const;
+};
@@ -0,0 +1,109 @@
+#include "RowCache.hpp"
+#include "ByteClass.hpp"
+#include "FrameStats.hpp"
+
+#include <algorithm>
+#include <array>
+
+namespace {
+constexpr size_t kChunk = 256; // 每次从数据源读取的字节数
+
+/// 字节值 -> "XX "（大写十六进制加空格）
+constexpr auto kHexCells = [] {
+  std::array<std::array<char, 3>, 256> table{};
+  constexpr char digits[] = "0123456789ABCDEF";
+  for (size_t i = 0; i < 256; ++i) {
+    table[i][0] = digits[i >> 4];
+    table[i][1] = digits[i & 0xF];
+    table[i][2] = ' ';
+  }
+  return table;
+}();
+
+/// 字节值 -> ASCII 列显示的字符（不可打印时为 '.'）
+constexpr auto kAsciiGlyphs = [] {
+  std::array<char, 256> table{};
+  for (size_t i = 0; i < 256; ++i)
+    table[i] = (i >= 0x20 && i <= 0x7E) ? static_cast<char>(i) : '.';
+  return table;
+}();
+
+constexpr char kAddrDigits[] = "0123456789abcdef";
+} // namespace
+
+const FormattedRow &RowCache::row(const DataBuffer &data, size_t addr,
+                                  size_t bytes_per_line, uint32_t mode,
+                                  size_t addr_width) {
+  const size_t line = bytes_per_line > 0 ? addr / bytes_per_line : addr;
+  FormattedRow &slot = slots_[line % slots_.size()];
+  const bool hit = slot.used && !data.live() && slot.addr == addr &&
+                   slot.bytes_per_line == bytes_per_line &&
+                   slot.mode == mode && slot.addr_width == addr_width &&
+                   slot.generation == data.generation() &&
+                   // 末行不满时，数据增长（后台加载/流式输入）后需要补齐
+                   (slot.valid == bytes_per_line ||
+                    slot.data_size == data.size());
+  if (hit)
+    return slot;
+
+  slot.addr = addr;
+  slot.bytes_per_line = bytes_per_line;
+  slot.mode = mode;
+  slot.addr_width = addr_width;
+  slot.generation = data.generation();
+  slot.used = true;
+  format(slot, data);
+  ++formatted_;
+  return slot;
+}
+
+void RowCache::reserve_rows(size_t rows) {
+  if (rows <= slots_.size())
+    return;
+  // 槽位下标依赖容量，扩容后旧内容全部作废
+  slots_.assign(rows, FormattedRow{});
+}
+
+void RowCache::clear() {
+  for (auto &slot : slots_)
+    slot.used = false;
+}
+
+void RowCache::format(FormattedRow &row, const DataBuffer &data) const {
+  row.data_size = data.size();
+
+  // 复用字符串已有的容量，稳定后不再分配
+  row.address.assign(row.addr_width + 2, ' ');
+  for (size_t i = 0; i < row.addr_width; ++i)
+    row.address[row.addr_width - 1 - i] = kAddrDigits[(row.addr >> (4 * i)) & 0xF];
+  row.address[row.addr_width] = ':';
+
+  row.hex.clear();
+  row.ascii.clear();
+  row.classes.resize(row.bytes_per_line);
+  std::array<uint8_t, kChunk> bytes{};
+  size_t done = 0;
+  while (done < row.bytes_per_line) {
+    size_t got = 0;
+    {
+      FrameStats::Scope timing(FrameSection::Data);
+      got = data.read(row.addr + done, bytes.data(),
+                      std::min(kChunk, row.bytes_per_line - done));
+    }
+    if (got == 0)
+      break;
+    // 整块一次分类，逐字节循环里不做判断
+    if (row.mode & kPlain)
+      std::fill_n(row.classes.data() + done, got, uint8_t{0});
+    else
+      classify_bytes(bytes.data(), row.classes.data() + done, got);
+    for (size_t k = 0; k < got; ++k) {
+      const auto &cell = kHexCells[bytes[k]];
+      row.hex.append(cell.data(), cell.size());
+      row.ascii.push_back(kAsciiGlyphs[bytes[k]]);
+    }
+    done += got;
+  }
+  row.valid = done;
+  row.classes.resize(done);
+}
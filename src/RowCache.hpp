@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "DataSource.hpp"
+
+// ========== RowCache ==========
+/// 一行格式化后的 Hex 视图内容（地址、十六进制、ASCII、字节类别），不含光标高亮
+struct FormattedRow {
+  // —— 缓存键 —— //
+  size_t addr = 0;
+  size_t bytes_per_line = 0;
+  uint32_t mode = 0;       // 显示模式（RowCache::kPlain 等）
+  size_t addr_width = 0;   // 地址列的十六进制位数
+  uint64_t generation = 0; // DataBuffer::generation()
+  bool used = false;
+
+  size_t valid = 0;       // 实际有数据的字节数（末行可能不足一行）
+  size_t data_size = 0;   // 格式化时的数据大小，末行在数据增长后需要重做
+  std::string address;    // "xxxxxxxx: "
+  std::string hex;        // 每字节 "XX "
+  std::string ascii;      // 每字节一个字符（不可打印为 '.'）
+  std::vector<uint8_t> classes; // 每字节的 ByteClass，绘制时查颜色表
+};
+
+/// Hex 视图的行缓存：以行号取模作为下标的环形缓冲区，键为
+/// (addr, bytes_per_line, mode, 地址宽度, 数据版本)。视口按行滚动时，
+/// 新露出的一行恰好覆盖离开视口最久的那一行，其余行原样复用；
+/// 光标高亮在绘制时叠加，因此移动光标不会让任何行失效。
+/// 数据源为 live() 时每次都重新格式化
+class RowCache {
+public:
+  static constexpr size_t kDefaultCapacity = 256;
+  /// mode 位：不按字节类别着色，格式化时跳过分类（classes 全为 0）
+  static constexpr uint32_t kPlain = 1;
+
+  explicit RowCache(size_t capacity = kDefaultCapacity)
+      : slots_(capacity > 0 ? capacity : 1) {}
+
+  /// 取得 addr 开始的一行，未命中时从 data 读取并格式化
+  const FormattedRow &row(const DataBuffer &data, size_t addr,
+                          size_t bytes_per_line, uint32_t mode,
+                          size_t addr_width);
+
+  /// 保证至少有 rows 个槽位（视口变高时扩容，已缓存的行失效）
+  void reserve_rows(size_t rows);
+
+  /// 清空所有槽位
+  void clear();
+
+  [[nodiscard]] size_t capacity() const { return slots_.size(); }
+
+  /// 累计格式化（未命中）的行数
+  [[nodiscard]] size_t formatted() const { return formatted_; }
+
+private:
+  void format(FormattedRow &row, const DataBuffer &data) const;
+
+  std::vector<FormattedRow> slots_;
+  size_t formatted_ = 0;
+};
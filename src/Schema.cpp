@@ -0,0 +1,311 @@
+#include "Schema.hpp"
+
+#include <fmt/format.h>
+
+#include <cctype>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+#include "AppState.hpp"
+
+namespace {
+// —— 各类型的读取函数：与 TypedReader / FixStringReader /
+//    LengthPrefixedStringReader 调用同样的 AppState 方法 —— //
+template <typename T>
+size_t read_scalar(AppState &state, size_t pos, uint32_t) {
+  (void)state.read<T>(pos);
+  return sizeof(T);
+}
+
+template <typename T>
+size_t read_scalars(AppState &state, size_t pos, uint32_t count) {
+  (void)state.read_array<T>(pos, count);
+  return size_t{count} * sizeof(T);
+}
+
+size_t read_chars(AppState &state, size_t pos, uint32_t count) {
+  (void)state.read_fixed_string(pos, count);
+  return count;
+}
+
+template <typename LengthType>
+size_t read_prefixed(AppState &state, size_t pos, uint32_t) {
+  return sizeof(LengthType) +
+         state.read_length_prefixed_string<LengthType>(pos).length;
+}
+
+template <typename LengthType>
+size_t peek_prefix(const AppState &state, size_t pos) {
+  return static_cast<size_t>(state.peek<LengthType>(pos));
+}
+
+struct ScalarEntry {
+  std::string name;
+  StructPlan::ReadFn one;
+  StructPlan::ReadFn many;
+  uint32_t size;
+};
+
+struct PrefixedEntry {
+  std::string name;
+  StructPlan::ReadFn read;
+  StructPlan::PeekFn peek;
+  uint32_t size;
+};
+
+template <typename T> ScalarEntry scalar_entry() {
+  return {TypeFactory::getTypeShortName<T>(), &read_scalar<T>,
+          &read_scalars<T>, sizeof(T)};
+}
+
+template <typename T> PrefixedEntry prefixed_entry() {
+  return {"string@" + TypeFactory::getTypeShortName<T>(), &read_prefixed<T>,
+          &peek_prefix<T>, sizeof(T)};
+}
+
+const ScalarEntry *find_scalar(const std::string &name) {
+  static const ScalarEntry kScalars[] = {
+      scalar_entry<uint8_t>(),  scalar_entry<int8_t>(),
+      scalar_entry<uint16_t>(), scalar_entry<int16_t>(),
+      scalar_entry<uint32_t>(), scalar_entry<int32_t>(),
+      scalar_entry<uint64_t>(), scalar_entry<int64_t>(),
+      scalar_entry<float>(),    scalar_entry<double>()};
+  for (const auto &entry : kScalars)
+    if (entry.name == name)
+      return &entry;
+  return nullptr;
+}
+
+const PrefixedEntry *find_prefixed(const std::string &name) {
+  // 与 ReaderFactory 登记的 string@… 一致
+  static const PrefixedEntry kPrefixed[] = {
+      prefixed_entry<uint8_t>(),  prefixed_entry<uint16_t>(),
+      prefixed_entry<uint32_t>(), prefixed_entry<int8_t>(),
+      prefixed_entry<int16_t>(),  prefixed_entry<int32_t>()};
+  for (const auto &entry : kPrefixed)
+    if (entry.name == name)
+      return &entry;
+  return nullptr;
+}
+
+/// 解析 "xxx[n]" 中的 n（n >= 1）；不是这种形式时返回 0
+uint32_t parse_extent(const std::string &type, size_t open) {
+  if (type.back() != ']' || open + 2 >= type.size())
+    return 0;
+  uint64_t n = 0;
+  for (size_t i = open + 1; i + 1 < type.size(); ++i) {
+    if (!std::isdigit(static_cast<unsigned char>(type[i])))
+      return 0;
+    n = n * 10 + static_cast<uint64_t>(type[i] - '0');
+    if (n > std::numeric_limits<uint32_t>::max())
+      return 0;
+  }
+  return static_cast<uint32_t>(n);
+}
+
+bool is_identifier(const std::string &s) {
+  if (s.empty() || std::isdigit(static_cast<unsigned char>(s[0])))
+    return false;
+  for (char c : s)
+    if (!std::isalnum(static_cast<unsigned char>(c)) && c != '_')
+      return false;
+  return true;
+}
+
+struct Token {
+  std::string text;
+  size_t line;
+};
+
+/// 切分为单词与 "{" "}" ";"，去掉注释
+std::vector<Token> tokenize(const std::string &text) {
+  std::vector<Token> tokens;
+  std::istringstream in(text);
+  std::string line;
+  for (size_t number = 1; std::getline(in, line); ++number) {
+    line = line.substr(0, std::min(line.find("//"), line.find('#')));
+    std::string word;
+    auto flush = [&] {
+      if (!word.empty())
+        tokens.push_back({std::move(word), number});
+      word.clear();
+    };
+    for (char c : line) {
+      if (std::isspace(static_cast<unsigned char>(c))) {
+        flush();
+      } else if (c == '{' || c == '}' || c == ';') {
+        flush();
+        tokens.push_back({std::string(1, c), number});
+      } else {
+        word += c;
+      }
+    }
+    flush();
+  }
+  return tokens;
+}
+} // namespace
+
+void StructPlan::add_field(const std::string &field, const std::string &type) {
+  Op op;
+  op.field = static_cast<uint16_t>(field_names.size());
+  if (field_names.size() >= std::numeric_limits<uint16_t>::max())
+    throw std::invalid_argument("too many fields");
+
+  if (const PrefixedEntry *p = find_prefixed(type)) {
+    op.read = p->read;
+    op.peek_len = p->peek;
+    op.size = p->size;
+  } else if (const size_t open = type.find('['); open != std::string::npos) {
+    const uint32_t n = parse_extent(type, open);
+    const std::string elem = type.substr(0, open);
+    const ScalarEntry *s = elem == "char" ? nullptr : find_scalar(elem);
+    if (n == 0 || (elem != "char" && s == nullptr))
+      throw std::invalid_argument(fmt::format("unsupported type '{}'", type));
+    if (uint64_t{n} * (s ? s->size : 1) > std::numeric_limits<uint32_t>::max())
+      throw std::invalid_argument(fmt::format("'{}' is too large", type));
+    op.read = s ? s->many : &read_chars;
+    op.count = n;
+    op.size = n * (s ? s->size : 1);
+  } else if (const ScalarEntry *s = find_scalar(type)) {
+    op.read = s->one;
+    op.size = s->size;
+  } else {
+    throw std::invalid_argument(fmt::format("unsupported type '{}'", type));
+  }
+
+  if (uint64_t{segment_} + op.size > std::numeric_limits<uint32_t>::max())
+    throw std::invalid_argument("struct is too large");
+  op.offset = segment_;
+  fixed_size_ += op.size;
+  // 变长字段之后的偏移从它的末尾重新算起
+  if (op.peek_len) {
+    segment_ = 0;
+    variable_ = true;
+  } else {
+    segment_ += op.size;
+  }
+  ops_.push_back(op);
+  field_names.push_back(field);
+  field_types.push_back(type);
+}
+
+size_t StructPlan::measure(const AppState &state, size_t start) const {
+  size_t base = start;
+  for (const Op &op : ops_) {
+    if (!op.peek_len)
+      continue;
+    const size_t pos = base + op.offset;
+    const size_t len = op.peek_len(state, pos);
+    if (len > state.data.size())
+      throw std::out_of_range("read past end of data");
+    base = pos + op.size + len;
+  }
+  const size_t total = base + segment_ - start;
+  state.data.require(start, total);
+  return total;
+}
+
+size_t StructPlan::apply(AppState &state, size_t start, size_t count) const {
+  if (count == 0 || ops_.empty())
+    return 0;
+  // 先检查整段范围：全部定长时一次算出，否则逐条查看长度前缀
+  size_t total = 0;
+  if (!variable_) {
+    if (count > std::numeric_limits<size_t>::max() / fixed_size_)
+      throw std::out_of_range("read past end of data");
+    total = fixed_size_ * count;
+    state.data.require(start, total);
+  } else {
+    for (size_t i = 0; i < count; ++i)
+      total += measure(state, start + total);
+  }
+
+  state.set_cursor_pos(start);
+  size_t pos = start;
+  for (size_t i = 0; i < count; ++i)
+    pos += apply_one(state, pos);
+  return total;
+}
+
+size_t StructPlan::apply_one(AppState &state, size_t start) const {
+  size_t base = start;
+  for (const Op &op : ops_) {
+    const size_t pos = base + op.offset;
+    const size_t n = op.read(state, pos, op.count);
+    if (op.peek_len)
+      base = pos + n;
+  }
+  return base + segment_ - start;
+}
+
+std::vector<StructPlan> compile_schema(const std::string &text) {
+  const std::vector<Token> tokens = tokenize(text);
+  std::vector<StructPlan> plans;
+  size_t i = 0;
+  // 在第 at 个单词处报错
+  auto fail = [&](size_t at, const std::string &msg) {
+    const size_t line = at < tokens.size() ? tokens[at].line
+                        : tokens.empty()   ? 1
+                                           : tokens.back().line;
+    throw std::invalid_argument(fmt::format("line {}: {}", line, msg));
+  };
+  auto next = [&]() -> const std::string & {
+    if (i >= tokens.size())
+      fail(i, "unexpected end of schema");
+    return tokens[i++].text;
+  };
+  auto expect = [&](const char *word) {
+    if (next() != word)
+      fail(i - 1, fmt::format("expected '{}'", word));
+  };
+
+  while (i < tokens.size()) {
+    expect("struct");
+    StructPlan plan;
+    plan.name = next();
+    if (!is_identifier(plan.name))
+      fail(i - 1, fmt::format("invalid struct name '{}'", plan.name));
+    for (const auto &other : plans)
+      if (other.name == plan.name)
+        fail(i - 1, fmt::format("struct '{}' defined twice", plan.name));
+    expect("{");
+
+    while (true) {
+      const size_t at = i;
+      const std::string type = next();
+      if (type == "}")
+        break;
+      const std::string field = next();
+      if (!is_identifier(field))
+        fail(at + 1, fmt::format("invalid field name '{}'", field));
+      for (const auto &name : plan.field_names)
+        if (name == field)
+          fail(at + 1, fmt::format("field '{}' defined twice", field));
+      expect(";");
+      try {
+        plan.add_field(field, type);
+      } catch (const std::invalid_argument &e) {
+        fail(at, e.what());
+      }
+    }
+    if (plan.ops().empty())
+      fail(i - 1, fmt::format("struct '{}' has no fields", plan.name));
+    // 允许 C 风格的 "};"
+    if (i < tokens.size() && tokens[i].text == ";")
+      ++i;
+    plans.push_back(std::move(plan));
+  }
+  return plans;
+}
+
+std::vector<StructPlan> load_schema_file(const std::string &path) {
+  std::ifstream in(path);
+  if (!in)
+    throw std::runtime_error("Cannot open schema file: " + path);
+  std::ostringstream text;
+  text << in.rdbuf();
+  return compile_schema(text.str());
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct AppState;
+
+// ========== StructPlan ==========
+/// 编译好的 struct 定义：字段展开成一条扁平的指令数组，每条指令直接指向
+/// 对应类型的读取函数，并带有预先算好的偏移。偏移相对于所在的“定长段”
+/// 起点——结构开头，或前一个变长字段（string@…）的末尾——所以全部是定长
+/// 字段时每个字段的位置在编译时就已确定，应用时不再解析类型名称。
+/// 字段按 TypedReader / FixStringReader / LengthPrefixedStringReader
+/// 同样的方式读取：每个字段在读取历史中各记一条，光标随之前移
+class StructPlan {
+public:
+  /// 读取 pos 处的字段并记入历史，返回消耗的字节数
+  using ReadFn = size_t (*)(AppState &state, size_t pos, uint32_t count);
+  /// 不读取地查看 pos 处变长字段的内容长度（仅变长字段）
+  using PeekFn = size_t (*)(const AppState &state, size_t pos);
+
+  struct Op {
+    ReadFn read = nullptr;
+    PeekFn peek_len = nullptr; // 非空表示变长字段
+    uint32_t offset = 0;       // 相对所在定长段起点的偏移
+    uint32_t count = 0;        // 数组元素数 / 字符串长度
+    uint32_t size = 0;         // 定长字段的字节数；变长字段为长度前缀的字节数
+    uint16_t field = 0;        // 字段下标
+  };
+
+  std::string name;
+  std::vector<std::string> field_names;
+  std::vector<std::string> field_types;
+
+  [[nodiscard]] const std::vector<Op> &ops() const { return ops_; }
+  /// 所有定长部分的字节数（全部定长时即记录大小）
+  [[nodiscard]] size_t fixed_size() const { return fixed_size_; }
+  [[nodiscard]] bool variable() const { return variable_; }
+
+  /// 追加一个字段；type 为读取命令所用的类型名（"u32"、"u16[4]"、
+  /// "char[20]"、"string@u16" 等），不支持时抛出 std::invalid_argument
+  void add_field(const std::string &field, const std::string &type);
+
+  /// start 处一条记录的字节数，不改动状态；越界时抛出 std::out_of_range
+  /// （仍在加载时抛出 DataPendingError）
+  [[nodiscard]] size_t measure(const AppState &state, size_t start) const;
+
+  /// 从 start 处连续应用 count 条记录，返回读取的总字节数。
+  /// 先检查整段范围，越界时不改动光标和历史
+  size_t apply(AppState &state, size_t start, size_t count = 1) const;
+
+private:
+  size_t apply_one(AppState &state, size_t start) const;
+
+  std::vector<Op> ops_;
+  size_t fixed_size_ = 0;
+  uint32_t segment_ = 0; // 编译时当前定长段已占用的字节数
+  bool variable_ = false;
+};
+
+// ========== Schema 解析 ==========
+/// 解析 schema 文本，每个定义形如
+///   struct Hdr { u32 msg_type; u32 body_len; char[20] sender; string@u16 text; }
+/// 支持 "//" 与 "#" 注释；语法错误抛出 std::invalid_argument（带行号）
+std::vector<StructPlan> compile_schema(const std::string &text);
+
+/// 读取并解析 schema 文件；打不开时抛出 std::runtime_error
+std::vector<StructPlan> load_schema_file(const std::string &path);
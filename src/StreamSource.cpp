@@ -0,0 +1,223 @@
+#include "StreamSource.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define BIN_READER_POSIX_IO 1
+#endif
+
+namespace {
+constexpr size_t kReadChunk = 64 * 1024;
+constexpr size_t kProgressBytes = 1024 * 1024; // 至少攒够这么多字节再通知
+constexpr auto kProgressInterval = std::chrono::milliseconds(50);
+} // namespace
+
+bool StreamSource::is_stream(const std::string &path) {
+  if (path == "-")
+    return true;
+#ifdef BIN_READER_POSIX_IO
+  struct stat st {};
+  // 字符设备（/dev/zero 等）可能无限长，整段落盘会写满磁盘，
+  // 交给有缓存上限的 BlockCacheSource 按需读取
+  return ::stat(path.c_str(), &st) == 0 &&
+         (S_ISFIFO(st.st_mode) || S_ISSOCK(st.st_mode));
+#else
+  return false;
+#endif
+}
+
+std::unique_ptr<StreamSource>
+StreamSource::open(const std::string &path, size_t memory_limit,
+                   std::function<void()> on_progress) {
+#ifdef BIN_READER_POSIX_IO
+  int fd = -1;
+  if (path == "-") {
+    fd = ::dup(STDIN_FILENO);
+    // stdin 被数据占用：把控制终端重新接到 fd 0，TUI 才能读取键盘
+    int tty = ::open("/dev/tty", O_RDONLY);
+    if (tty >= 0) {
+      ::dup2(tty, STDIN_FILENO);
+      ::close(tty);
+    }
+  } else {
+    fd = ::open(path.c_str(), O_RDONLY);
+  }
+  if (fd < 0)
+    return nullptr;
+  return from_fd(fd, memory_limit, std::move(on_progress));
+#else
+  (void)path;
+  (void)memory_limit;
+  (void)on_progress;
+  return nullptr;
+#endif
+}
+
+std::unique_ptr<StreamSource>
+StreamSource::from_fd(int fd, size_t memory_limit,
+                      std::function<void()> on_progress) {
+  std::unique_ptr<StreamSource> source(
+      new StreamSource(fd, memory_limit, std::move(on_progress)));
+  source->worker_ = std::thread(&StreamSource::run, source.get());
+  return source;
+}
+
+StreamSource::StreamSource(int fd, size_t memory_limit,
+                           std::function<void()> on_progress)
+    : fd_(fd), memory_limit_(memory_limit),
+      on_progress_(std::move(on_progress)) {
+#ifdef BIN_READER_POSIX_IO
+  if (memory_limit_ > 0) {
+    void *addr = ::mmap(nullptr, memory_limit_, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (addr != MAP_FAILED)
+      memory_ = static_cast<uint8_t *>(addr);
+    else
+      memory_limit_ = 0;
+  }
+  if (::pipe(wake_fds_) != 0)
+    wake_fds_[0] = wake_fds_[1] = -1;
+#endif
+}
+
+StreamSource::~StreamSource() {
+  stop_.store(true);
+#ifdef BIN_READER_POSIX_IO
+  if (wake_fds_[1] >= 0) {
+    const char byte = 0;
+    [[maybe_unused]] auto n = ::write(wake_fds_[1], &byte, 1);
+  }
+#endif
+  if (worker_.joinable())
+    worker_.join();
+#ifdef BIN_READER_POSIX_IO
+  for (int fd : wake_fds_)
+    if (fd >= 0)
+      ::close(fd);
+  if (fd_ >= 0)
+    ::close(fd_);
+  if (memory_)
+    ::munmap(memory_, memory_limit_);
+#endif
+  if (spill_)
+    std::fclose(spill_);
+}
+
+void StreamSource::run() {
+#ifdef BIN_READER_POSIX_IO
+  std::vector<uint8_t> chunk(kReadChunk);
+  size_t total = 0;
+  size_t notified = 0;
+  auto last_notify = std::chrono::steady_clock::now();
+
+  while (!stop_.load()) {
+    pollfd fds[2] = {{fd_, POLLIN, 0}, {wake_fds_[0], POLLIN, 0}};
+    if (::poll(fds, wake_fds_[0] >= 0 ? 2 : 1, -1) < 0) {
+      if (errno == EINTR)
+        continue;
+      break;
+    }
+    if (fds[1].revents)
+      break;
+
+    const ssize_t got = ::read(fd_, chunk.data(), chunk.size());
+    if (got < 0 && (errno == EINTR || errno == EAGAIN))
+      continue;
+    if (got <= 0)
+      break;
+    if (!store(chunk.data(), static_cast<size_t>(got), total))
+      break;
+    total += static_cast<size_t>(got);
+    received_.store(total, std::memory_order_release);
+
+    // 高速输入时限制通知频率，避免向 UI 投递过多重绘事件
+    const auto now = std::chrono::steady_clock::now();
+    if (on_progress_ && (total - notified >= kProgressBytes ||
+                         now - last_notify >= kProgressInterval)) {
+      notified = total;
+      last_notify = now;
+      on_progress_();
+    }
+  }
+#endif
+  finish();
+}
+
+bool StreamSource::store(const uint8_t *bytes, size_t n, size_t at) {
+  // 先填满内存区域
+  if (at < memory_limit_) {
+    const size_t in_memory = std::min(n, memory_limit_ - at);
+    std::memcpy(memory_ + at, bytes, in_memory);
+    bytes += in_memory;
+    n -= in_memory;
+  }
+  if (n == 0)
+    return true;
+
+  // 剩余部分追加到临时文件
+  if (!spill_ && !(spill_ = std::tmpfile()))
+    return false;
+#ifdef BIN_READER_POSIX_IO
+  const int fd = fileno(spill_);
+  while (n > 0) {
+    const ssize_t written = ::write(fd, bytes, n);
+    if (written < 0 && errno == EINTR)
+      continue;
+    if (written <= 0)
+      return false;
+    bytes += written;
+    n -= static_cast<size_t>(written);
+  }
+#endif
+  return true;
+}
+
+void StreamSource::finish() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    eof_.store(true, std::memory_order_release);
+  }
+  eof_cv_.notify_all();
+  if (on_progress_)
+    on_progress_();
+}
+
+void StreamSource::wait() const {
+  std::unique_lock<std::mutex> lock(mutex_);
+  eof_cv_.wait(lock, [this] { return eof_.load(); });
+}
+
+size_t StreamSource::read(size_t pos, uint8_t *dst, size_t n) const {
+  const size_t total = size();
+  if (pos >= total)
+    return 0;
+  n = std::min(n, total - pos);
+
+  size_t done = 0;
+  if (pos < memory_limit_) {
+    done = std::min(n, memory_limit_ - pos);
+    std::memcpy(dst, memory_ + pos, done);
+  }
+#ifdef BIN_READER_POSIX_IO
+  while (done < n) {
+    const ssize_t got =
+        ::pread(fileno(spill_), dst + done, n - done,
+                static_cast<off_t>(pos + done - memory_limit_));
+    if (got < 0 && errno == EINTR)
+      continue;
+    if (got <= 0)
+      break;
+    done += static_cast<size_t>(got);
+  }
+#endif
+  return done;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "DataSource.hpp"
+
+// ========== StreamSource ==========
+/// 从 stdin、管道或 FIFO 流式读取的数据源：后台线程持续接收数据，
+/// 前 memory_limit 字节放在匿名内存区域中，超出部分写入临时文件（落盘），
+/// 内存占用不超过 memory_limit；size() 随数据到达而增长
+class StreamSource : public DataSource {
+public:
+  /// path 为 "-" 时读取 stdin（并把终端重新接到 fd 0 供 TUI 读取键盘），
+  /// 否则打开 FIFO/字符设备等流式文件
+  static std::unique_ptr<StreamSource>
+  open(const std::string &path, size_t memory_limit,
+       std::function<void()> on_progress = {});
+
+  /// 接管已打开的 fd（析构时关闭）
+  static std::unique_ptr<StreamSource>
+  from_fd(int fd, size_t memory_limit, std::function<void()> on_progress = {});
+
+  /// path 是否应作为流读取（"-"、FIFO、套接字；字符设备不算）
+  static bool is_stream(const std::string &path);
+
+  ~StreamSource() override;
+  StreamSource(const StreamSource &) = delete;
+  StreamSource &operator=(const StreamSource &) = delete;
+
+  [[nodiscard]] size_t size() const override {
+    return received_.load(std::memory_order_acquire);
+  }
+  size_t read(size_t pos, uint8_t *dst, size_t n) const override;
+  [[nodiscard]] bool loading() const override {
+    return !eof_.load(std::memory_order_acquire);
+  }
+  [[nodiscard]] bool immutable() const override { return true; }
+
+  /// 阻塞直到输入结束
+  void wait() const;
+
+  /// 已落盘的字节数
+  [[nodiscard]] size_t spilled_bytes() const {
+    const size_t total = size();
+    return total > memory_limit_ ? total - memory_limit_ : 0;
+  }
+
+private:
+  StreamSource(int fd, size_t memory_limit, std::function<void()> on_progress);
+
+  void run();
+  bool store(const uint8_t *bytes, size_t n, size_t at);
+  void finish();
+
+  int fd_ = -1;
+  size_t memory_limit_ = 0;
+  uint8_t *memory_ = nullptr; // 匿名映射，按需提交物理页
+  std::FILE *spill_ = nullptr; // 超出内存上限后的临时文件
+  std::function<void()> on_progress_;
+
+  std::atomic<size_t> received_{0};
+  std::atomic<bool> eof_{false};
+  std::atomic<bool> stop_{false};
+  int wake_fds_[2] = {-1, -1}; // 析构时唤醒阻塞在 poll 上的读取线程
+  mutable std::mutex mutex_;
+  mutable std::condition_variable eof_cv_;
+  std::thread worker_;
+};
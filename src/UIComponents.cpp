@@ -1,15 +1,23 @@
 #include <fmt/format.h>
+#include <ftxui/component/animation.hpp>
 #include <ftxui/component/component.hpp>
 #include <ftxui/component/screen_interactive.hpp>
 #include <ftxui/dom/elements.hpp>
 
+#include <array>
 #include <cstdint>
 #include <iostream>
+#include <memory>
 #include <string>
+#include <tuple>
 #include <vector>
 
 #include "AppState.hpp"
+#include "DataPreview.hpp"
 #include "EventHandlers.hpp"
+#include "FrameStats.hpp"
+#include "HexGrid.hpp"
+#include "PerfHud.hpp"
 #include "UIComponents.hpp"
 #include "Utils.hpp"
 
@@ -22,6 +30,7 @@ Component MainUi(AppState &state, std::string &cmd, ScreenInteractive &screen) {
   // Build each panel
   auto status_bar = StatusBar(state);
   auto hex_view = HexView(state);
+  auto minimap = Minimap(state);
   auto data_preview = DataPreviewBar(state);
   auto data_history = DataReadHistoryBar(state);
 
@@ -30,7 +39,8 @@ Component MainUi(AppState &state, std::string &cmd, ScreenInteractive &screen) {
 
   // Arrange hex_view, data_preview, and data_history horizontally
   auto workspace = Container::Horizontal({
-                       hex_view | flex | size(WIDTH, EQUAL, 150),
+                       hex_view | flex,
+                       Maybe(minimap, &state.show_minimap),
                        data_preview | size(WIDTH, EQUAL, 35),
                        data_history | size(WIDTH, EQUAL, 35),
                    }) |
@@ -44,15 +54,42 @@ Component MainUi(AppState &state, std::string &cmd, ScreenInteractive &screen) {
                 }) |
                 flex;
 
+  // Frame timing wraps the whole tree; the HUD overlays the top-right corner
+  // Navigation keys are batched and applied once per frame, right before
+  // drawing: the loop drains every queued key event before it renders
+  state.batch_navigation = true;
+  auto root = Renderer(layout, [&state, layout] {
+    FrameStats &perf = FrameStats::instance();
+    perf.begin_frame();
+    state.flush_commands();
+    Element main = layout->Render();
+    if (!perf.enabled())
+      return main;
+    return FrameEnd(dbox({
+        main,
+        vbox({text(""), hbox({filler(), PerfHud()})}),
+    }));
+  });
+
   // Send an initial focus event so the command line gets focus on startup
   screen.PostEvent(Event::Custom);
 
   // Wrap with an event catcher to handle custom events, commands, and
   // navigation
-  return CatchEvent(layout, [&](const Event &event) {
-    // On the first Custom event, set focus to the command line
+  auto focused = std::make_shared<bool>(false);
+  return CatchEvent(root, [&, focused](const Event &event) {
+    // On the first Custom event, set focus to the command line; later ones
+    // must not pull focus away from the hex view
     if (event == Event::Custom) {
-      command_line->TakeFocus();
+      if (!*focused) {
+        *focused = true;
+        command_line->TakeFocus();
+      }
+      return true;
+    }
+
+    // Clicks on the minimap jump to the block under the mouse
+    if (event.is_mouse() && state.show_minimap && minimap->OnEvent(event)) {
       return true;
     }
 
@@ -67,149 +104,196 @@ Component MainUi(AppState &state, std::string &cmd, ScreenInteractive &screen) {
 }
 
 Component HexView(AppState &state) {
-  return Renderer([&] {
-           const size_t content_height = state.hex_view_h;
-           const size_t start_line = state.current_page * content_height;
-           Elements lines;
-
-           for (size_t i = 0; i < content_height; ++i) {
-             const size_t addr = (start_line + i) * state.bytes_per_line;
-             if (addr >= state.data.size())
-               break;
-
-             Elements hex_cells;
-             Elements ascii_cells;
-
-             for (size_t j = 0; j < state.bytes_per_line; ++j) {
-               const size_t pos = addr + j;
-               const bool is_active = (pos == state.cursor_pos);
-
-               if (pos >= state.data.size()) {
-                 // Past end of data: render spaces
-                 hex_cells.push_back(text("   "));
-                 ascii_cells.push_back(text(" "));
-                 continue;
-               }
-
-               const uint8_t byte = state.data[pos];
-               // Hex representation (two hex digits + space)
-               hex_cells.push_back(text(fmt::format("{:02X} ", byte)) |
-                                   (is_active ? inverted : nothing));
-               // ASCII representation (printable or dot)
-               char disp = (byte >= 0x20 && byte <= 0x7E)
-                               ? static_cast<char>(byte)
-                               : '.';
-               ascii_cells.push_back(text(std::string(1, disp)) |
-                                     color(Color::Yellow) |
-                                     (is_active ? inverted : nothing));
-             }
-
-             // Combine address, hex cells, separator, and ASCII cells
-             lines.push_back(hbox({
-                 text(fmt::format("{:08x}: ", addr)) | color(Color::Blue),
-                 hbox(hex_cells),
-                 text("│") | color(Color::GrayDark),
-                 hbox(ascii_cells),
-             }));
-           }
-
-           return vbox(lines);
-         }) |
-         border;
+  auto cache = std::make_shared<RowCache>();
+  auto box = std::make_shared<Box>(); // 上一帧 HexView 得到的区域
+  auto fitted = std::make_shared<std::tuple<int, int, bool>>(0, 0, false);
+  return Renderer([&state, cache, box, fitted] {
+    FrameStats::Scope scope(FrameSection::HexView);
+    // 区域大小（或 fit 设置）变化后重新计算行宽与行数；边框占去两行两列
+    const int width = box->x_max - box->x_min + 1;
+    const int height = box->y_max - box->y_min + 1;
+    if (state.auto_fit && width > 2 && height > 2 &&
+        std::make_tuple(width, height, state.fit_pow2) != *fitted) {
+      *fitted = std::make_tuple(width, height, state.fit_pow2);
+      // 新布局下一帧才生效，立即再画一帧
+      if (state.fit_view(static_cast<size_t>(width - 2),
+                         static_cast<size_t>(height - 2)))
+        animation::RequestAnimationFrame();
+    }
+    return Timed(FrameSection::HexView,
+                 HexGrid(state, *cache) | border | reflect(*box));
+  });
+}
+
+Component Minimap(AppState &state) {
+  auto box = std::make_shared<Box>(); // 上一帧小地图得到的区域
+  auto view = Renderer([&state, box] {
+    FrameStats::Scope scope(FrameSection::Minimap);
+    // 每行汇总若干个块：背景色为熵（蓝=低、红=高），字符标出
+    // 大部分为零 ' '、大部分可打印 't'、接近随机 '#'，尚未计算 '·'
+    const int height = box->y_max - box->y_min - 1;
+    const size_t rows =
+        height > 0 ? static_cast<size_t>(height) : state.hex_view_h;
+    const BlockStats *stats = state.minimap_stats();
+    Elements lines;
+    if (!stats) {
+      lines.push_back(text(state.data.loading() ? "…" : " ") | dim);
+      return Timed(FrameSection::Minimap, vbox(std::move(lines)) | border |
+                                              reflect(*box) |
+                                              size(WIDTH, EQUAL, 4));
+    }
+
+    const size_t cells = stats->cells();
+    const size_t cursor_cell = stats->cell_at(state.cursor_pos);
+    for (size_t r = 0; r < rows; ++r) {
+      const size_t first = r * cells / rows;
+      const size_t last = std::max(first + 1, (r + 1) * cells / rows);
+      const BlockSummary s = stats->summary(first, last);
+      const double heat = s.entropy / 8;
+      Color bg = Color::RGB(static_cast<uint8_t>(heat * 255), 48,
+                            static_cast<uint8_t>((1 - heat) * 255));
+      if (s.unreadable)
+        bg = Color::Red; // 读取出错
+      else if (s.zero_ratio > 0.9)
+        bg = Color::Black;
+      const char *glyph = s.unreadable                ? "!"
+                          : s.level == 0              ? "·"
+                          : s.zero_ratio > 0.9        ? " "
+                          : s.printable_ratio > 0.75  ? "t"
+                          : s.entropy > 7.5           ? "#"
+                                                      : " ";
+      const bool here = cursor_cell >= first && cursor_cell < last;
+      lines.push_back(hbox({
+          text(glyph) | bgcolor(bg) | color(Color::White),
+          text(here ? "◀" : " ") | color(Color::Yellow),
+      }));
+    }
+    const size_t count = lines.size();
+    return Timed(FrameSection::Minimap, vbox(std::move(lines)) | border |
+                                            reflect(*box) |
+                                            size(WIDTH, EQUAL, 4),
+                 count);
+  });
+  return CatchEvent(view, [&state, box](Event event) {
+    if (!event.is_mouse() || event.mouse().button != Mouse::Left ||
+        event.mouse().motion != Mouse::Pressed)
+      return false;
+    const int x = event.mouse().x;
+    const int y = event.mouse().y;
+    // 边框内的行才对应块
+    if (!box->Contain(x, y) || y <= box->y_min || y >= box->y_max)
+      return false;
+    state.minimap_jump(static_cast<size_t>(y - box->y_min - 1),
+                       static_cast<size_t>(box->y_max - box->y_min - 1));
+    return true;
+  });
 }
 
 Component StatusBar(AppState &state) {
   return Renderer([&] {
-    return hbox({
+    FrameStats::Scope scope(FrameSection::StatusBar);
+    state.show_source_error();
+    // 拼接多个文件时附上光标所在的文件名
+    std::string file = state.file_name;
+    if (const Segment *seg = state.segment_at(state.cursor_pos))
+      file = fmt::format("{} [{}]", state.file_name, seg->name);
+    Elements parts = {
         text(fmt::format(" Pos: 0x{:08x} ", state.cursor_pos)) |
             bgcolor(Color::DarkBlue),
-        text(fmt::format(" Page: {}/{} ", state.current_page + 1,
-                         state.total_pages())) |
+        text(fmt::format(" Page: {}/{}{} ", state.current_page + 1,
+                         state.total_pages(),
+                         state.data.loading() ? " (loading)" : "")) |
             bgcolor(Color::DarkGreen),
         text(fmt::format(" {} ", state.status_msg)) | bgcolor(Color::DarkRed),
-        text(fmt::format(" File: {} ", state.file_name)) |
+        text(fmt::format(" File: {} ", file)) |
             bgcolor(Color::DarkBlue) | flex,
-    });
+    };
+    const size_t count = parts.size();
+    return Timed(FrameSection::StatusBar, hbox(std::move(parts)), count);
   });
 }
 
-template <typename T>
-void populate(std::vector<std::pair<std::string, std::string>> &data_types,
-              AppState &state, size_t pos) {
-  std::string label = TypeFactory::getTypeShortName<T>();
-  try {
-    data_types.emplace_back(label, Utils::format_value(state.peek<T>(pos)));
-  } catch (const std::out_of_range &e) {
-    data_types.emplace_back(label, "N/A");
-  }
-}
-
 Component DataPreviewBar(AppState &state) {
-  return Renderer([&] {
-    size_t pos = state.cursor_pos;
-    auto endian_str = state.is_little_endian ? "LE" : "BE";
-
-    // Populate data types with different sizes
-    std::vector<std::pair<std::string, std::string>> data_types;
-
-    populate<uint8_t>(data_types, state, pos);
-    populate<uint16_t>(data_types, state, pos);
-    populate<uint32_t>(data_types, state, pos);
-    populate<uint64_t>(data_types, state, pos);
-    populate<int8_t>(data_types, state, pos);
-    populate<int16_t>(data_types, state, pos);
-    populate<int32_t>(data_types, state, pos);
-    populate<int64_t>(data_types, state, pos);
-    populate<float>(data_types, state, pos);
-    populate<double>(data_types, state, pos);
-
-    std::unordered_map<std::string, Color> type_colors = {
-        {"u8", Color::Cyan},     {"u16", Color::Cyan},
-        {"u32", Color::Cyan},    {"u64", Color::Cyan},
-
-        {"i8", Color::Yellow},   {"i16", Color::Yellow},
-        {"i32", Color::Yellow},  {"i64", Color::Yellow},
-
-        {"f32", Color::Magenta}, {"f64", Color::Magenta},
-    };
+  // 与 DataPreview::kFields 一一对应的颜色：无符号/有符号/浮点
+  static const std::array<Color, DataPreview::kTypes> kFieldColors = {
+      Color::Cyan,   Color::Cyan,   Color::Cyan,   Color::Cyan,
+      Color::Yellow, Color::Yellow, Color::Yellow, Color::Yellow,
+      Color::Magenta, Color::Magenta,
+  };
+  // 标签只格式化一次
+  static const std::array<std::string, DataPreview::kTypes> kLabels = [] {
+    std::array<std::string, DataPreview::kTypes> labels;
+    for (size_t i = 0; i < DataPreview::kTypes; ++i)
+      labels[i] = fmt::format("{:>3}: ", DataPreview::kFields[i].label);
+    return labels;
+  }();
+  auto preview = std::make_shared<DataPreview>();
+
+  return Renderer([&state, preview] {
+    FrameStats::Scope scope(FrameSection::DataPreview);
+    // 光标、字节序与数据都没变时 update 不重新解码，直接用缓存的文本；
+    // 元素树每帧重新搭建（FTXUI 的节点带有每帧的布局状态，不能跨帧复用）
+    preview->update(state.data, state.cursor_pos, state.is_little_endian);
 
     Elements data_lines;
     data_lines.push_back(hbox({
         text("Endian:") | bold | color(Color::Green),
-        text(endian_str),
+        text(preview->little_endian() ? "LE" : "BE"),
     }));
-    for (const auto &[type, value] : data_types) {
-      Color c = type_colors.find(type) != type_colors.end() ? type_colors[type]
-                                                            : Color::White;
+    for (size_t i = 0; i < DataPreview::kTypes; ++i) {
       data_lines.push_back(hbox({
-          text(fmt::format("{:>3}: ", type)) | color(c),
-          text(value) | flex_grow,
+          text(kLabels[i]) | color(kFieldColors[i]),
+          text(preview->values()[i]) | flex_grow,
       }));
     }
 
-    return vbox(std::move(data_lines)) | border | size(WIDTH, EQUAL, 30);
+    const size_t count = data_lines.size();
+    return Timed(FrameSection::DataPreview,
+                 vbox(std::move(data_lines)) | border | size(WIDTH, EQUAL, 30),
+                 count);
   });
 }
 
 Component DataReadHistoryBar(AppState &state) {
-  return Renderer([&] {
-    // Get the history of read operations
-    std::vector<Record> records = state.get_read_history();
-    Elements history_lines;
+  auto box = std::make_shared<Box>();
+  return Renderer([&state, box] {
+    FrameStats::Scope scope(FrameSection::History);
+    // 只渲染可见的记录：可见行数取上一帧面板的实际高度（去掉边框），
+    // 第一帧尚未布局时先按 40 行
+    const int height = box->y_max - box->y_min - 1;
+    size_t rows = height > 0 ? static_cast<size_t>(height) : 40;
+    const size_t total = state.read_history.size();
+    if (total > rows && rows > 1)
+      --rows; // 留一行显示位置
+    const auto [first, last] = state.history_window(rows);
+
+    // 字符串记录只读取面板宽度以内的字符
+    const int width = box->x_max - box->x_min - 1;
+    const size_t max_chars =
+        width > 0 ? static_cast<size_t>(width) : ReadHistory::kPreviewChars;
 
-    for (const auto &record : records) {
+    Elements history_lines;
+    for (size_t i = first; i < last; ++i) {
+      const ReadHistory &history = state.read_history;
       history_lines.push_back(hbox({
           // Address (in hex)
-          text(fmt::format("{:08X}:", record.index)) | color(Color::Green) |
-              flex_shrink,
+          text(fmt::format("{:08X}:", history[i].index)) |
+              color(Color::Green) | flex_shrink,
           // Type name
-          text(" " + record.type_name + ": ") | color(Color::Green),
+          text(" " + history.type_name(i) + ": ") | color(Color::Green),
           // Data value
-          text(Utils::format_any(record.data)) | flex_grow,
+          text(history.format(i, state.data, max_chars)) | flex_grow,
       }));
     }
-
-    return vbox(std::move(history_lines)) | border | size(WIDTH, EQUAL, 30);
+    if (last - first < total)
+      history_lines.push_back(
+          text(fmt::format("{}-{} / {}", first + 1, last, total)) | dim);
+
+    const size_t count = history_lines.size();
+    return Timed(FrameSection::History,
+                 vbox(std::move(history_lines)) | border | reflect(*box) |
+                     size(WIDTH, EQUAL, 30),
+                 count);
   });
 }
 
@@ -22,6 +22,7 @@ namespace UIComponents {
 
   Component StatusBar(AppState& state);
   Component HexView(AppState& state);
+  Component Minimap(AppState& state);
   Component DataPreviewBar(AppState& state);
   Component DataReadHistoryBar(AppState& state);
   Component CommandLine(AppState& state, std::string& command_input);
@@ -1,19 +1,91 @@
 #pragma once
+#include <algorithm>
+#include <filesystem>
 #include <fmt/format.h>
 #include <fstream>
 #include <iterator>
+#include <string>
 #include <type_traits>
 #include <vector>
 
 #include "CLI11.hpp"
+#include "DataSource.hpp"
+#include "ProcMemSource.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <glob.h>
+#endif
 
 namespace Utils {
-inline std::string ParseCommandLine(int argc, char **argv) {
-  CLI::App app{"bin-reader"};
-  std::string file_path;
+/// 命令行参数
+struct CliOptions {
+  std::vector<std::string> file_paths; // 多个文件按顺序拼接
+  OpenOptions open;                    // 数据源打开选项
+  std::string schema_path;             // 启动时加载的 struct 定义文件
+};
+
+/// 展开通配符（如 "feed.*.bin"），匹配结果按文件名排序；
+/// 不含通配符或没有匹配时原样返回
+inline std::vector<std::string> expand_file_pattern(const std::string &pattern) {
+#if defined(__unix__) || defined(__APPLE__)
+  if (pattern.find_first_of("*?[") != std::string::npos) {
+    glob_t matches{};
+    std::vector<std::string> paths;
+    if (glob(pattern.c_str(), 0, nullptr, &matches) == 0) {
+      for (size_t i = 0; i < matches.gl_pathc; ++i)
+        paths.emplace_back(matches.gl_pathv[i]);
+    }
+    globfree(&matches);
+    if (!paths.empty())
+      return paths;
+  }
+#endif
+  return {pattern};
+}
 
-  app.add_option("-f,--file", file_path, "Binary file to load")
+inline CliOptions ParseCommandLine(int argc, char **argv) {
+  CLI::App app{"bin-reader"};
+  CliOptions options;
+  size_t cache_mb = options.open.cache_bytes >> 20;
+  size_t gz_span_mb = options.open.gz_span >> 20;
+  size_t mem_limit_mb = options.open.memory_limit >> 20;
+  bool no_mmap = false;
+  bool raw = false;
+
+  std::vector<std::string> patterns;
+  app.add_option("-f,--file", patterns,
+                 "Binary file(s) or glob to load, concatenated in order "
+                 "(\"-\" reads stdin, \"pid:N\" a live process)")
       ->required()
+      ->check(CLI::Validator(
+          [](std::string &pattern) -> std::string {
+            for (const auto &path : expand_file_pattern(pattern)) {
+              if (path == "-" || ProcMemSource::parse_pid(path))
+                continue;
+              std::error_code ec;
+              if (!std::filesystem::exists(path, ec) ||
+                  std::filesystem::is_directory(path, ec))
+                return "File does not exist: " + path;
+            }
+            return {};
+          },
+          "FILE"));
+  app.add_option("--cache-mb", cache_mb,
+                 "Block cache limit in MiB when the file is not mapped")
+      ->check(CLI::PositiveNumber);
+  app.add_option("--mem-limit-mb", mem_limit_mb,
+                 "Memory kept for stdin/pipe input before spilling to disk")
+      ->check(CLI::NonNegativeNumber);
+  app.add_flag("--no-mmap", no_mmap,
+               "Read through the block cache instead of mmap");
+  app.add_flag("--preload", options.open.preload,
+               "Load the whole file into memory on a background thread");
+  app.add_flag("--raw", raw, "Show .gz files as compressed bytes");
+  app.add_option("--gz-span-mb", gz_span_mb,
+                 "Distance in MiB between gzip index checkpoints")
+      ->check(CLI::PositiveNumber);
+  app.add_option("--schema", options.schema_path,
+                 "Struct definitions to load for the apply command")
       ->check(CLI::ExistingFile);
 
   try {
@@ -22,7 +94,23 @@ inline std::string ParseCommandLine(int argc, char **argv) {
     std::exit(app.exit(e));
   }
 
-  return file_path;
+  for (const auto &pattern : patterns) {
+    for (auto &path : expand_file_pattern(pattern))
+      options.file_paths.push_back(std::move(path));
+  }
+  if (options.file_paths.size() > 1 &&
+      std::find(options.file_paths.begin(), options.file_paths.end(), "-") !=
+          options.file_paths.end()) {
+    fmt::print(stderr, "stdin (\"-\") cannot be concatenated with files\n");
+    std::exit(static_cast<int>(CLI::ExitCodes::ValidationError));
+  }
+
+  options.open.cache_bytes = cache_mb << 20;
+  options.open.use_mmap = !no_mmap;
+  options.open.gunzip = !raw;
+  options.open.gz_span = gz_span_mb << 20;
+  options.open.memory_limit = mem_limit_mb << 20;
+  return options;
 }
 
 // 数值格式化模板函数
@@ -40,38 +128,21 @@ template <typename T> inline std::string format_value(T value) {
   }
 }
 
-inline std::string format_any(const std::any &data) {
-  // 有符号整数
-  if (typeid(int8_t) == data.type())
-    return format_value(std::any_cast<int8_t>(data));
-  if (typeid(int16_t) == data.type())
-    return format_value(std::any_cast<int16_t>(data));
-  if (typeid(int32_t) == data.type())
-    return format_value(std::any_cast<int32_t>(data));
-  if (typeid(int64_t) == data.type())
-    return format_value(std::any_cast<int64_t>(data));
-
-  // 无符号整数
-  if (typeid(uint8_t) == data.type())
-    return format_value(std::any_cast<uint8_t>(data));
-  if (typeid(uint16_t) == data.type())
-    return format_value(std::any_cast<uint16_t>(data));
-  if (typeid(uint32_t) == data.type())
-    return format_value(std::any_cast<uint32_t>(data));
-  if (typeid(uint64_t) == data.type())
-    return format_value(std::any_cast<uint64_t>(data));
-
-  // 浮点数
-  if (typeid(float) == data.type())
-    return format_value(std::any_cast<float>(data));
-  if (typeid(double) == data.type())
-    return format_value(std::any_cast<double>(data));
-
-  // 其他类型
-  if (typeid(std::string) == data.type())
-    return std::any_cast<std::string>(data);
-
-  return "Unsupported Type";
+/// 数组显示前 kArrayPreview 个元素，其余以元素总数概括
+inline constexpr size_t kArrayPreview = 8;
+
+template <typename T>
+inline std::string format_array(const std::vector<T> &values) {
+  std::string out = "[";
+  const size_t shown = std::min(values.size(), kArrayPreview);
+  for (size_t i = 0; i < shown; ++i) {
+    if (i > 0)
+      out += ", ";
+    out += format_value(values[i]);
+  }
+  if (shown < values.size())
+    out += fmt::format(", … ({} total)", values.size());
+  return out + "]";
 }
 
 inline std::vector<uint8_t> read_binary_file(const std::string &path) {
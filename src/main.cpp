@@ -14,12 +14,20 @@ using namespace ftxui; // 统一使用命名空间
 int main(int argc, char **argv) {
   try {
     // Initialize application
-    const std::string file_path = Utils::ParseCommandLine(argc, argv);
+    Utils::CliOptions options = Utils::ParseCommandLine(argc, argv);
     register_all_commands();
     auto screen = ScreenInteractive::Fullscreen();
     AppState state;
-    // Load initial file
-    state.load_file(file_path);
+    // Background watchers hand their updates to the UI thread
+    state.post_task = [&screen](std::function<void()> task) {
+      screen.Post(std::move(task));
+    };
+    // Load initial file; background loaders ask the UI to redraw as data
+    // arrives (a no-op task, so focus stays where the user left it)
+    options.open.on_progress = [&screen] { screen.Post([] {}); };
+    state.load_files(options.file_paths, options.open);
+    if (!options.schema_path.empty())
+      state.load_schema(options.schema_path);
     // Setup and run UI
     std::string cmd;
     auto ui = UIComponents::MainUi(state, cmd, screen);
@@ -1,5 +1,6 @@
 #include "AppState.hpp"
 #include <gtest/gtest.h>
+#include <limits>
 
 // --------- AppState 基础测试 ---------
 TEST(AppStateTest, PeekAndRead_uint16) {
@@ -21,10 +22,11 @@ TEST(AppStateTest, PeekAndRead_uint16) {
   EXPECT_EQ(state.cursor_pos, sizeof(uint16_t));
   // read_history 应该有 1 条记录，记录 index=0，data=0x2211
   {
-    auto hist = state.get_read_history();
+    const auto &hist = state.get_read_history();
     ASSERT_EQ(hist.size(), 1u);
     EXPECT_EQ(hist[0].index, 0u);
-    EXPECT_EQ(std::any_cast<uint16_t>(hist[0].data), (uint16_t)0x2211);
+    EXPECT_EQ(hist.value<uint16_t>(0), (uint16_t)0x2211);
+    EXPECT_THROW((void)hist.value<int16_t>(0), std::bad_cast);
   }
 
   // 再次 read，cursor 在 2 位置
@@ -39,15 +41,16 @@ TEST(AppStateTest, ReadFixedStringAndUndo) {
   state.data = {'H', 'e', 'l', 'l', 'o', 'X'};
 
   // read_fixed_string(0,5)
-  std::string str = state.read_fixed_string(0, 5);
-  EXPECT_EQ(str, "Hello");
+  const ByteSpan str = state.read_fixed_string(0, 5);
+  EXPECT_EQ(state.text(str), "Hello");
   EXPECT_EQ(state.cursor_pos, 5u);
   // read_history 只有一条，index=0，data="Hello"
   {
-    auto hist = state.get_read_history();
+    const auto &hist = state.get_read_history();
     ASSERT_EQ(hist.size(), 1u);
     EXPECT_EQ(hist[0].index, 0u);
-    EXPECT_EQ(std::any_cast<std::string>(hist[0].data), "Hello");
+    EXPECT_EQ(hist.format(0, state.data), "Hello");
+    EXPECT_EQ(hist.type_name(0), "char[5]");
   }
 
   // undo：将 cursor_pos 回退到 0，history 为空
@@ -59,6 +62,56 @@ TEST(AppStateTest, ReadFixedStringAndUndo) {
   EXPECT_THROW(state.read_fixed_string(2, 10), std::out_of_range);
 }
 
+TEST(AppStateTest, UndoRedoBranches) {
+  AppState state;
+  state.data = {1, 0, 2, 0, 'a', 'b', 'c', 'd'};
+
+  (void)state.read<uint16_t>(0);
+  (void)state.read<uint16_t>(2);
+  state.undo();
+  EXPECT_EQ(state.cursor_pos, 2u);
+  EXPECT_TRUE(state.redo());
+  EXPECT_EQ(state.cursor_pos, 4u);
+  EXPECT_EQ(state.read_history.back().index, 2u);
+  EXPECT_FALSE(state.redo());
+
+  // 撤销后读取字符串，开出第二个分支
+  state.undo();
+  (void)state.read_fixed_string(2, 3);
+  const auto &hist = state.read_history;
+  ASSERT_EQ(hist.size(), 2u);
+  EXPECT_EQ(hist.type_name(1), "char[3]");
+  EXPECT_EQ(hist.log_size(), 3u);
+
+  state.undo();
+  EXPECT_EQ(hist.branch_count(), 2u);
+  // redo 默认进入最近的分支，字符串读完后光标在其末尾
+  EXPECT_TRUE(state.redo());
+  EXPECT_EQ(hist.type_name(1), "char[3]");
+  EXPECT_EQ(state.cursor_pos, 5u);
+
+  state.undo();
+  EXPECT_EQ(state.read_history.switch_branch(), 2u);
+  EXPECT_TRUE(state.redo());
+  EXPECT_EQ(hist.type_name(1), "u16");
+  EXPECT_EQ(hist.value<uint16_t>(1), 2u);
+  EXPECT_EQ(state.cursor_pos, 4u);
+
+  // 整个日志按追加顺序可以遍历，父记录指向读取前的 head
+  EXPECT_EQ(hist.log_parent(0), ReadHistory::kNone);
+  EXPECT_EQ(hist.log_parent(1), 0u);
+  EXPECT_EQ(hist.log_parent(2), 0u);
+
+  // 全部撤销到根后仍可逐条 redo
+  state.undo();
+  state.undo();
+  EXPECT_TRUE(hist.empty());
+  EXPECT_EQ(state.cursor_pos, 0u);
+  EXPECT_TRUE(state.redo());
+  EXPECT_TRUE(state.redo());
+  EXPECT_EQ(hist.size(), 2u);
+}
+
 TEST(AppStateTest, ReadLengthPrefixedString) {
   AppState state;
   // 构造：长度前缀 uint8_t=3，后跟 'A','B','C'
@@ -67,17 +120,21 @@ TEST(AppStateTest, ReadLengthPrefixedString) {
   state.cursor_pos = 0;
 
   // 读 u8 前缀 + 固定字符串
-  std::string lp = state.read_length_prefixed_string<uint8_t>(0);
-  EXPECT_EQ(lp, "ABC");
+  const ByteSpan lp = state.read_length_prefixed_string<uint8_t>(0);
+  EXPECT_EQ(state.text(lp), "ABC");
   // cursor_pos 前进 1+3=4
   EXPECT_EQ(state.cursor_pos, 4u);
 
-  // read_history 只保留合并后的一个 Record (index=0, data="ABC")
+  // read_history 只保留合并后的一条记录 (index=0, data="ABC")
   {
-    auto hist = state.get_read_history();
+    const auto &hist = state.get_read_history();
     ASSERT_EQ(hist.size(), 1u);
     EXPECT_EQ(hist[0].index, 0u);
-    EXPECT_EQ(std::any_cast<std::string>(hist[0].data), "ABC");
+    EXPECT_EQ(hist.format(0, state.data), "ABC");
+    // 记录只引用数据中的位置
+    EXPECT_EQ(hist.span(0).offset, 1u);
+    EXPECT_EQ(hist.span(0).length, 3u);
+    EXPECT_EQ(hist.type_name(0), "string@u8");
   }
 
   // 越界恢复测试：前缀值超过剩余字节长度
@@ -150,6 +207,45 @@ TEST(AppStateTest, CursorMovementAndPages) {
   EXPECT_EQ(state.current_page, 4u);
 }
 
+TEST(AppStateTest, SmoothScrollKeepsViewAnchoredToCursor) {
+  AppState state;
+  state.data.resize(100, 0xFF);
+  state.bytes_per_line = 10;
+  state.hex_view_h = 3;
+  state.set_smooth_scroll(true);
+
+  // 视口内移动不滚动
+  EXPECT_TRUE(state.next_line());
+  EXPECT_TRUE(state.next_line());
+  EXPECT_EQ(state.top_line, 0u);
+
+  // 越过视口底部：视口只下移一行，不跳到页边界
+  EXPECT_TRUE(state.next_line());
+  EXPECT_EQ(state.cursor_pos, 30u);
+  EXPECT_EQ(state.top_line, 1u);
+  EXPECT_EQ(state.view_start(), 10u);
+
+  // 翻页：视口与光标一起移动 hex_view_h 行
+  EXPECT_TRUE(state.next_page());
+  EXPECT_EQ(state.cursor_pos, 60u);
+  EXPECT_EQ(state.top_line, 4u);
+
+  // 视口不会越过最后一屏
+  EXPECT_TRUE(state.next_page());
+  EXPECT_EQ(state.top_line, 7u);
+  EXPECT_EQ(state.cursor_pos, 90u);
+  EXPECT_FALSE(state.next_page());
+
+  EXPECT_TRUE(state.pre_page());
+  EXPECT_EQ(state.cursor_pos, 60u);
+  EXPECT_EQ(state.top_line, 4u);
+  EXPECT_TRUE(state.next_page());
+
+  // 关闭后回到按页对齐
+  state.set_smooth_scroll(false);
+  EXPECT_EQ(state.view_start(), 3u * 3 * 10);
+}
+
 TEST(AppStateTest, SetCursorPosBoundaries) {
   AppState state;
   state.data.resize(10, 0x00);
@@ -205,6 +301,73 @@ TEST(ReaderFactoryTest, TypedReader_float_bigEndian) {
   }
 }
 
+TEST(ReaderFactoryTest, ArrayReadIsOneHistoryEntry) {
+  AppState state;
+  state.data = {0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x01,
+                0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x03};
+  state.is_little_endian = false;
+  register_all_commands();
+
+  // r u32 3 @4：跳到 4，整段按大端解码
+  CommandRegistry::instance().dispatch(ParsedCommand::parse("r u32 3 @0x4"),
+                                       state);
+  ASSERT_EQ(state.read_history.size(), 1u);
+  const ReadHistory &history = state.read_history;
+  EXPECT_EQ(history.back().index, 4u);
+  EXPECT_EQ(history.type_name(0), "u32[3]");
+  EXPECT_EQ(history.back().length, 12u);
+  EXPECT_EQ(history.format(0, state.data), "[1, 2, 3]");
+  EXPECT_EQ(state.cursor_pos, 16u);
+  EXPECT_NE(state.status_msg.find("Read u32[3]: [1, 2, 3] @ 0x4"),
+            std::string::npos);
+
+  // 一次撤销回到数组起点
+  state.undo();
+  EXPECT_TRUE(state.read_history.empty());
+  EXPECT_EQ(state.cursor_pos, 4u);
+
+  // 越界时不移动光标、不记录
+  CommandRegistry::instance().dispatch(ParsedCommand::parse("r u32 4"), state);
+  EXPECT_TRUE(state.read_history.empty());
+  EXPECT_EQ(state.cursor_pos, 4u);
+
+  // 带 @addr 的读取失败时光标也留在原处
+  CommandRegistry::instance().dispatch(ParsedCommand::parse("r u32 2 @12"),
+                                       state);
+  EXPECT_TRUE(state.read_history.empty());
+  EXPECT_EQ(state.cursor_pos, 4u);
+
+  // 大写的 0X 前缀同样按十六进制
+  CommandRegistry::instance().dispatch(ParsedCommand::parse("r u8 @0X0A"),
+                                       state);
+  ASSERT_EQ(state.read_history.size(), 1u);
+  EXPECT_EQ(state.read_history.back().index, 10u);
+  state.undo();
+  EXPECT_EQ(state.cursor_pos, 10u);
+  state.set_cursor_pos(4);
+
+  // 负数不会被回绕成极大值
+  CommandRegistry::instance().dispatch(ParsedCommand::parse("r u8 @-1"), state);
+  EXPECT_NE(state.status_msg.find("Usage"), std::string::npos);
+  CommandRegistry::instance().dispatch(ParsedCommand::parse("r u8 -1"), state);
+  EXPECT_NE(state.status_msg.find("Usage"), std::string::npos);
+  EXPECT_EQ(state.cursor_pos, 4u);
+}
+
+TEST(ReaderFactoryTest, ByteSwapKernelMatchesScalar) {
+  std::vector<uint8_t> bytes(200);
+  for (size_t i = 0; i < bytes.size(); ++i)
+    bytes[i] = static_cast<uint8_t>(i);
+  for (size_t width : {2u, 4u, 8u}) {
+    for (size_t count : {1u, 3u, 4u, 8u, 17u}) {
+      std::vector<uint8_t> fast = bytes, slow = bytes;
+      byteswap_array(fast.data() + 1, width, count);
+      byteswap_array_scalar(slow.data() + 1, width, count);
+      EXPECT_EQ(fast, slow) << "width=" << width << " count=" << count;
+    }
+  }
+}
+
 TEST(ReaderFactoryTest, FixStringReader_SuccessAndFail) {
   {
     AppState state;
@@ -289,15 +452,72 @@ TEST(ReaderFactoryTest, UnknownType) {
   EXPECT_TRUE(state.status_msg.empty());
 }
 
-// --------- Record.description() 测试 ---------
+// --------- ReadHistory 测试 ---------
 
 TEST(RecordTest, DescriptionFormatting) {
-  Record r1(0x10, (uint16_t)0x1234);
-  r1.type_name = "u16";
-  // description: index:0x00000010; type_name:u16; ... 这里只验证前缀部分包含
-  // "00000010:u16:"
-  std::string desc = r1.description();
-  EXPECT_NE(desc.find("00000010:u16:"), std::string::npos);
+  ReadHistory history;
+  history.push(0x10, (uint16_t)0x1234);
+  // description: index:0x00000010; type_name:u16; value
+  EXPECT_EQ(history.description(0, DataBuffer{}), "00000010:u16:4660");
+}
+
+TEST(RecordTest, ColumnarStoreInternsTypesAndPopsBlob) {
+  const DataBuffer data = {'a', 'b', 'c', 'x', 'y', 'z', 'd', 'e', 'f'};
+  ReadHistory history;
+  const size_t builtin = history.type_count();
+  history.push(0, int8_t{-1});
+  history.push(1, 2.5);
+  const uint16_t chars = history.intern("char[3]", ReadHistory::Kind::Chars);
+  history.push_chars(0, chars, ByteSpan{0, 3});
+  const int16_t pair[] = {-2, 300};
+  history.push_array(12, pair, 2);
+  history.push_chars(3, chars, ByteSpan{3, 3});
+
+  // 同名类型只登记一次
+  EXPECT_EQ(history.intern("char[3]", ReadHistory::Kind::Chars), chars);
+  EXPECT_EQ(history.type_count(), builtin + 2);
+
+  ASSERT_EQ(history.size(), 5u);
+  EXPECT_EQ(history.format(0, data), "-1");
+  EXPECT_EQ(history.format(1, data), "2.500");
+  EXPECT_EQ(history.format(2, data), "abc");
+  EXPECT_EQ(history.type_name(3), "i16[2]");
+  EXPECT_EQ(history.format(3, data), "[-2, 300]");
+  EXPECT_EQ(history.format(4, data), "xyz");
+  // 只取出可见的字符
+  EXPECT_EQ(history.format(4, data, 2), "xy…");
+
+  // 撤销后再追加开出新分支，旧记录与其字节区内容仍在日志中
+  EXPECT_TRUE(history.undo());
+  EXPECT_TRUE(history.undo());
+  const int16_t one[] = {7};
+  history.push_array(12, one, 1);
+  EXPECT_EQ(history.size(), 4u);
+  EXPECT_EQ(history.format(3, data), "[7]");
+  EXPECT_EQ(history.log_size(), 6u);
+  EXPECT_EQ(history.log_parent(5), 2u);
+  EXPECT_EQ(history.log_entry(3).index, 12u);
+}
+
+TEST(RecordTest, SwitchedBranchRedoesWholeChain) {
+  ReadHistory history;
+  history.push(0, uint8_t{0});
+  history.push(1, uint8_t{1});
+  history.push(2, uint8_t{2});
+  history.undo();
+  history.undo();
+  history.push(1, uint8_t{3}); // 第二个分支
+  history.undo();
+  EXPECT_EQ(history.branch_count(), 2u);
+
+  // 切回第一个分支后可以一路 redo 到它的末尾
+  EXPECT_EQ(history.switch_branch(), 2u);
+  EXPECT_TRUE(history.redo());
+  EXPECT_TRUE(history.redo());
+  EXPECT_FALSE(history.redo());
+  ASSERT_EQ(history.size(), 3u);
+  EXPECT_EQ(history.value<uint8_t>(2), 2u);
+  EXPECT_EQ(history.log_size(), 4u);
 }
 
 TEST(TypeTraitsTest, BasicTypeNames) {
@@ -353,4 +573,205 @@ TEST(TypeTraitsTest, DefaultUnknownType) {
   struct UnknownType {};
   EXPECT_STREQ(TypeTraits<UnknownType>::short_name, "unknown");
   EXPECT_STREQ(TypeTraits<UnknownType>::name, "unknown");
-}
\ No newline at end of file
+}
+TEST(AppStateTest, NavigationBurstIsAppliedOncePerFrame) {
+  AppState state;
+  state.data.resize(4096, 0x00);
+  state.bytes_per_line = 16;
+  state.batch_navigation = true;
+
+  // 按住向下：两帧之间的事件只累计，不移动光标
+  for (int i = 0; i < 40; ++i)
+    state.queue_command(Command{CommandType::MoveDown});
+  for (int i = 0; i < 3; ++i)
+    state.queue_command(Command{CommandType::MoveUp}); // 与向下抵消
+  state.queue_command(Command{CommandType::MoveRight});
+  EXPECT_EQ(state.cursor_pos, 0u);
+
+  // 绘制前一次执行整个批次
+  state.flush_commands();
+  EXPECT_EQ(state.cursor_pos, 37u * 16 + 1);
+  EXPECT_TRUE(state.input.empty());
+
+  // 越界的批量移动停在最后一行
+  state.apply_command(Command{CommandType::MoveDown}, 1000);
+  EXPECT_EQ(state.cursor_pos, 4096u - 16 + 1);
+
+  // 没有 UI 批处理时立即执行
+  state.batch_navigation = false;
+  state.queue_command(Command{CommandType::MoveLeft});
+  EXPECT_EQ(state.cursor_pos, 4096u - 16);
+}
+
+TEST(AppStateTest, InputBatcherMergesAndCancels) {
+  InputBatcher batcher;
+  batcher.push(CommandType::PageDown);
+  batcher.push(CommandType::PageDown);
+  batcher.push(CommandType::MoveLeft);
+  batcher.push(CommandType::MoveRight);
+  batcher.push(CommandType::Jump); // 非导航命令不进入批次
+  auto runs = batcher.take();
+  ASSERT_EQ(runs.size(), 1u);
+  EXPECT_EQ(runs[0].type, CommandType::PageDown);
+  EXPECT_EQ(runs[0].count, 2u);
+  EXPECT_TRUE(batcher.empty());
+}
+
+TEST(AppStateTest, HistoryWindowFollowsNewestAndScrolls) {
+  AppState state;
+  state.data.resize(1000, 0x01);
+  for (int i = 0; i < 100; ++i)
+    state.read<uint8_t>(state.cursor_pos);
+  ASSERT_EQ(state.read_history.size(), 100u);
+  EXPECT_EQ(state.read_history[42].index, 42u);
+
+  // 默认显示最新的 rows 条
+  EXPECT_EQ(state.history_window(40), std::make_pair(size_t{60}, size_t{100}));
+
+  state.scroll_history(25);
+  EXPECT_EQ(state.history_window(40), std::make_pair(size_t{35}, size_t{75}));
+
+  // 滚动范围限制在记录数之内，滚到顶时显示最早的一屏
+  state.scroll_history(1000);
+  EXPECT_EQ(state.history_window(40), std::make_pair(size_t{0}, size_t{40}));
+  state.scroll_history(-1000);
+  EXPECT_EQ(state.history_scroll, 0u);
+
+  // hist 命令：负数与非数字被拒绝，极大的滚动量等于滚到顶
+  register_all_commands();
+  auto hist = [&state](const char *line) {
+    CommandRegistry::instance().dispatch(ParsedCommand::parse(line), state);
+  };
+  hist("hist up -5");
+  EXPECT_EQ(state.status_msg, "Invalid history offset.");
+  EXPECT_EQ(state.history_scroll, 0u);
+  hist("hist up 5x");
+  EXPECT_EQ(state.status_msg, "Invalid history offset.");
+  hist("hist up 18446744073709551615");
+  EXPECT_EQ(state.history_scroll, 100u);
+  hist("hist down 0x10");
+  EXPECT_EQ(state.history_scroll, 84u);
+  state.scroll_history(std::numeric_limits<long>::min());
+  EXPECT_EQ(state.history_scroll, 0u);
+
+  state.undo();
+  EXPECT_EQ(state.read_history.size(), 99u);
+  EXPECT_EQ(state.cursor_pos, 99u);
+}
+
+TEST(AppStateTest, FitViewKeepsCursorByte) {
+  AppState state;
+  state.data.resize(1 << 16, 0x00);
+  state.set_cursor_pos(1000);
+
+  // 200 列：(200 - 11) / 4 = 47 -> 取 2 的幂 32
+  EXPECT_TRUE(state.fit_view(200, 40));
+  EXPECT_EQ(state.bytes_per_line, 32u);
+  EXPECT_EQ(state.hex_view_h, 40u);
+  EXPECT_EQ(state.cursor_pos, 1000u);
+  EXPECT_EQ(state.current_page, 1000u / (32 * 40));
+  EXPECT_FALSE(state.fit_view(200, 40));
+
+  state.fit_pow2 = false;
+  EXPECT_TRUE(state.fit_view(200, 40));
+  EXPECT_EQ(state.bytes_per_line, 47u);
+
+  // 平滑滚动时光标保持在屏幕上的同一行
+  state.set_smooth_scroll(true);
+  const size_t row = state.cursor_pos / state.bytes_per_line - state.top_line;
+  EXPECT_TRUE(state.fit_view(100, 20));
+  EXPECT_EQ(state.bytes_per_line, 22u);
+  EXPECT_EQ(state.cursor_pos / state.bytes_per_line - state.top_line,
+            std::min<size_t>(row, 19));
+}
+
+TEST(AppStateTest, MinimapJumpMovesCursorToBlock) {
+  AppState state;
+  state.data.resize(1 << 16, 0x00);
+  const BlockStats *stats = state.minimap_stats();
+  ASSERT_NE(stats, nullptr);
+  EXPECT_EQ(stats->cells(), AppState::kMinimapCells);
+  // 同一份数据不重新计算
+  EXPECT_EQ(state.minimap_stats(), stats);
+
+  // 共 4 行，第 3 行（从 0 起第 2 行）对应后半部分的开头
+  EXPECT_TRUE(state.minimap_jump(2, 4));
+  EXPECT_EQ(state.cursor_pos, 1u << 15);
+  EXPECT_FALSE(state.minimap_jump(4, 4));
+
+  // 数据变化后重新计算
+  state.data.resize(1 << 12, 0x00);
+  const BlockStats *resized = state.minimap_stats();
+  ASSERT_NE(resized, nullptr);
+  EXPECT_EQ(resized->data_size(), 1u << 12);
+}
+
+TEST(SchemaTest, CompilesFixedOffsetsAndAppliesLikeReaders) {
+  const auto plans = compile_schema(R"(
+    // 消息头
+    struct Hdr { u32 msg_type; u16 body_len; char[3] tag; string@u8 text; u16 crc; }
+    struct Pair { i16 a; u8[2] b; };
+  )");
+  ASSERT_EQ(plans.size(), 2u);
+  const StructPlan &hdr = plans[0];
+  ASSERT_EQ(hdr.ops().size(), 5u);
+  // 偏移在编译时算好，变长字段之后从其末尾重新计
+  EXPECT_EQ(hdr.ops()[0].offset, 0u);
+  EXPECT_EQ(hdr.ops()[1].offset, 4u);
+  EXPECT_EQ(hdr.ops()[2].offset, 6u);
+  EXPECT_EQ(hdr.ops()[3].offset, 9u);
+  EXPECT_EQ(hdr.ops()[4].offset, 0u);
+  EXPECT_EQ(hdr.fixed_size(), 12u);
+  EXPECT_TRUE(hdr.variable());
+  EXPECT_FALSE(plans[1].variable());
+  EXPECT_EQ(plans[1].fixed_size(), 4u);
+
+  AppState state;
+  state.data = {7, 0, 0, 0, 5, 0, 'a', 'b', 'c', 2, 'h', 'i', 0x34, 0x12,
+                0xFE, 0xFF, 1, 2, 0xFD, 0xFF, 3, 4};
+  for (auto plan : plans)
+    state.schemas.emplace(plan.name, std::move(plan));
+
+  EXPECT_EQ(state.apply_struct("Hdr", 0), 14u);
+  EXPECT_EQ(state.cursor_pos, 14u);
+  const auto &hist = state.read_history;
+  ASSERT_EQ(hist.size(), 5u);
+  EXPECT_EQ(hist.value<uint32_t>(0), 7u);
+  EXPECT_EQ(hist.value<uint16_t>(1), 5u);
+  EXPECT_EQ(hist.format(2, state.data), "abc");
+  EXPECT_EQ(hist.type_name(3), "string@u8");
+  EXPECT_EQ(hist[3].index, 9u);
+  EXPECT_EQ(hist.format(3, state.data), "hi");
+  EXPECT_EQ(hist.value<uint16_t>(4), 0x1234u);
+
+  // 定长 struct 连续应用多条
+  EXPECT_EQ(state.apply_struct("Pair", 14, 2), 8u);
+  ASSERT_EQ(hist.size(), 9u);
+  EXPECT_EQ(hist.value<int16_t>(5), -2);
+  EXPECT_EQ(hist.format(6, state.data), "[1, 2]");
+  EXPECT_EQ(hist.value<int16_t>(7), -3);
+  EXPECT_EQ(state.cursor_pos, 22u);
+
+  // 越界时整条不读取
+  EXPECT_THROW(state.apply_struct("Pair", 16, 2), std::out_of_range);
+  EXPECT_THROW(state.apply_struct("Hdr", 10), std::out_of_range);
+  EXPECT_EQ(hist.size(), 9u);
+  EXPECT_EQ(state.cursor_pos, 22u);
+  EXPECT_THROW(state.apply_struct("Nope", 0), std::invalid_argument);
+}
+
+TEST(SchemaTest, RejectsInvalidDefinitions) {
+  EXPECT_THROW(compile_schema("struct A { u24 x; }"), std::invalid_argument);
+  EXPECT_THROW(compile_schema("struct A { u8 x; u8 x; }"),
+               std::invalid_argument);
+  EXPECT_THROW(compile_schema("struct A { char[0] s; }"),
+               std::invalid_argument);
+  EXPECT_THROW(compile_schema("struct A { u8 x }"), std::invalid_argument);
+  EXPECT_THROW(compile_schema("struct A { }"), std::invalid_argument);
+  try {
+    (void)compile_schema("struct A {\n  u8 a;\n  bogus b;\n}");
+    FAIL();
+  } catch (const std::invalid_argument &e) {
+    EXPECT_EQ(std::string(e.what()), "line 3: unsupported type 'bogus'");
+  }
+}
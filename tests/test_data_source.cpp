@@ -0,0 +1,664 @@
+#include "AppState.hpp"
+#include "ConcatSource.hpp"
+#include "DataSource.hpp"
+#include "Prefetcher.hpp"
+#include "ProcMemSource.hpp"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+
+namespace {
+// 在临时目录写入一个测试文件，返回其路径
+std::string write_temp_file(const std::string &name,
+                            const std::vector<uint8_t> &bytes) {
+  auto path = std::filesystem::temp_directory_path() / name;
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  out.write(reinterpret_cast<const char *>(bytes.data()),
+            static_cast<std::streamsize>(bytes.size()));
+  return path.string();
+}
+} // namespace
+
+TEST(DataSourceTest, MmapSourceMapsRegularFile) {
+  const std::string path =
+      write_temp_file("bin_reader_mmap.bin", {0x01, 0x02, 0x03, 0x04, 0x05});
+
+  auto source = MmapSource::open(path);
+  ASSERT_NE(source, nullptr);
+  EXPECT_EQ(source->size(), 5u);
+  ASSERT_NE(source->contiguous(), nullptr);
+
+  // 越过末尾时截断
+  uint8_t buf[4] = {};
+  EXPECT_EQ(source->read(3, buf, 4), 2u);
+  EXPECT_EQ(buf[0], 0x04);
+  EXPECT_EQ(buf[1], 0x05);
+  EXPECT_EQ(source->read(5, buf, 1), 0u);
+}
+
+TEST(DataSourceTest, MappedFileGrowsOnRefresh) {
+  const std::string path = write_temp_file("bin_reader_grow.bin", {});
+
+  auto source = open_data_source(path);
+  ASSERT_NE(dynamic_cast<MmapSource *>(source.get()), nullptr);
+  EXPECT_EQ(source->size(), 0u);
+
+  {
+    std::ofstream out(path, std::ios::binary | std::ios::app);
+    out.write("\x01\x02\x03", 3);
+  }
+  EXPECT_EQ(source->refresh(), 3u);
+  uint8_t buf[3] = {};
+  EXPECT_EQ(source->read(0, buf, 3), 3u);
+  EXPECT_EQ(buf[2], 0x03);
+}
+
+TEST(DataSourceTest, MappedGrowthStaysInReservedMapping) {
+  const std::string path =
+      write_temp_file("bin_reader_reserve.bin", {0x01, 0x02});
+  DataBuffer data;
+  data.reset(open_data_source(path));
+  const uint8_t *base = data.source()->contiguous();
+  ASSERT_NE(base, nullptr);
+
+  // 大小不变时数据版本号不变
+  const uint64_t generation = data.generation();
+  EXPECT_EQ(data.refresh(), 0u);
+  EXPECT_EQ(data.generation(), generation);
+
+  {
+    std::ofstream out(path, std::ios::binary | std::ios::app);
+    out.write("\x03\x04", 2);
+  }
+  EXPECT_EQ(data.refresh(), 2u);
+  EXPECT_GT(data.generation(), generation);
+  // 增长落在预留的余量内，不需要重新映射
+  EXPECT_EQ(data.source()->contiguous(), base);
+  EXPECT_EQ(data[3], 0x04);
+
+  // 监视方报告写入时即使大小不变也视为已变化
+  const uint64_t grown = data.generation();
+  EXPECT_EQ(data.refresh(true), 0u);
+  EXPECT_GT(data.generation(), grown);
+}
+
+TEST(DataSourceTest, TruncatedMappingReadsZeroInsteadOfFaulting) {
+  const std::vector<uint8_t> bytes(3 * 65536, 0x5A);
+  const std::string path = write_temp_file("bin_reader_truncate.bin", bytes);
+  auto source = open_data_source(path);
+  const uint8_t *base = source->contiguous();
+  ASSERT_NE(base, nullptr);
+
+  std::filesystem::resize_file(path, 10);
+  EXPECT_EQ(source->refresh(), 10u);
+  // 仍按旧大小读取的线程读到 0，而不是 SIGBUS
+  EXPECT_EQ(base[2 * 65536], 0);
+  EXPECT_EQ(base[9], 0x5A);
+
+  // 再次增长后重新映射，新增部分读到文件内容
+  {
+    std::ofstream out(path, std::ios::binary | std::ios::app);
+    out.write(reinterpret_cast<const char *>(bytes.data()), 65536);
+  }
+  EXPECT_EQ(source->refresh(), 10u + 65536);
+  uint8_t byte = 0;
+  EXPECT_EQ(source->read(40000, &byte, 1), 1u);
+  EXPECT_EQ(byte, 0x5A);
+}
+
+TEST(DataSourceTest, AppStateReadsThroughMappedFile) {
+  const std::string path =
+      write_temp_file("bin_reader_state.bin", {0x11, 0x22, 0x33, 0x44});
+
+  AppState state;
+  state.load_file(path);
+  EXPECT_EQ(state.file_name, "bin_reader_state.bin");
+  EXPECT_EQ(state.data.size(), 4u);
+  EXPECT_EQ(state.peek<uint32_t>(0), 0x44332211u);
+  EXPECT_THROW(state.peek<uint32_t>(1), std::out_of_range);
+  EXPECT_EQ(state.text(state.read_fixed_string(1, 2)), "\x22\x33");
+}
+
+TEST(DataSourceTest, HistoryKeepsStringsReadFromRewrittenFile) {
+  const std::string path =
+      write_temp_file("bin_reader_rewrite.bin", {0x03, 'a', 'b', 'c', 'd'});
+
+  AppState state;
+  state.load_file(path);
+  EXPECT_FALSE(state.data.immutable());
+  (void)state.read_length_prefixed_string<uint8_t>(0);
+  (void)state.read_fixed_string(4, 1);
+
+  // 原地改写文件：历史显示的仍是读取时的内容，位置不变
+  {
+    std::fstream out(path, std::ios::binary | std::ios::in | std::ios::out);
+    out.write("\x03xyzw", 5);
+  }
+  state.data.refresh(true);
+  ASSERT_EQ(state.data[1], 'x');
+  const auto &hist = state.get_read_history();
+  ASSERT_EQ(hist.size(), 2u);
+  EXPECT_EQ(hist.format(0, state.data), "abc");
+  EXPECT_EQ(hist.format(0, state.data, 2), "ab…");
+  EXPECT_EQ(hist.type_name(0), "string@u8");
+  EXPECT_EQ(hist.span(0).offset, 1u);
+  EXPECT_EQ(hist.end_of(0), 4u);
+  EXPECT_EQ(hist.description(1, state.data), "00000004:char[1]:d");
+
+  // 长字符串只拷贝开头的预览，不随长度增长
+  AppState large;
+  large.load_file(write_temp_file("bin_reader_long.bin",
+                                  std::vector<uint8_t>(4096, 'q')));
+  (void)large.read_fixed_string(0, 4096);
+  const auto &long_hist = large.get_read_history();
+  EXPECT_EQ(long_hist[0].length, 4096u);
+  EXPECT_EQ(long_hist.bytes(0).size(), ReadHistory::kPreviewChars);
+  EXPECT_EQ(long_hist.format(0, large.data, 100),
+            std::string(ReadHistory::kPreviewChars, 'q') + "…");
+  EXPECT_EQ(long_hist.end_of(0), 4096u);
+
+  // 内存中的数据不会再变，只记位置
+  AppState memory;
+  memory.data = {'h', 'i'};
+  EXPECT_TRUE(memory.data.immutable());
+  (void)memory.read_fixed_string(0, 2);
+  EXPECT_EQ(memory.get_read_history().type(memory.get_read_history()[0].type)
+                .kind,
+            ReadHistory::Kind::Chars);
+}
+
+TEST(DataSourceTest, DataBufferVectorCompatibility) {
+  DataBuffer buffer = {0xAA, 0xBB};
+  EXPECT_EQ(buffer.size(), 2u);
+  EXPECT_EQ(buffer[1], 0xBB);
+
+  // resize 保留原有内容并用填充值补齐
+  buffer.resize(4, 0xCC);
+  ASSERT_EQ(buffer.size(), 4u);
+  EXPECT_EQ(buffer[0], 0xAA);
+  EXPECT_EQ(buffer[3], 0xCC);
+
+  uint8_t out[2] = {};
+  EXPECT_THROW(buffer.copy(3, out, 2), std::out_of_range);
+  buffer.copy(2, out, 2);
+  EXPECT_EQ(out[0], 0xCC);
+
+  DataBuffer empty;
+  EXPECT_TRUE(empty.empty());
+  EXPECT_THROW(empty.copy(0, out, 1), std::out_of_range);
+}
+
+TEST(DataSourceTest, BlockCacheCrossesBlockBoundaries) {
+  std::vector<uint8_t> bytes(40);
+  for (size_t i = 0; i < bytes.size(); ++i)
+    bytes[i] = static_cast<uint8_t>(i);
+  const std::string path = write_temp_file("bin_reader_blocks.bin", bytes);
+
+  // 8 字节一块，最多缓存 2 块
+  auto source = BlockCacheSource::open(path, 16, 8);
+  ASSERT_NE(source, nullptr);
+  EXPECT_EQ(source->size(), 40u);
+
+  uint8_t buf[12] = {};
+  EXPECT_EQ(source->read(6, buf, 12), 12u); // 跨越第 0、1、2 块
+  for (size_t i = 0; i < 12; ++i)
+    EXPECT_EQ(buf[i], 6 + i);
+  EXPECT_LE(source->cached_blocks(), 2u);
+
+  // 末尾不足一块
+  EXPECT_EQ(source->read(36, buf, 8), 4u);
+  EXPECT_EQ(buf[3], 39);
+  EXPECT_LE(source->cached_blocks(), 2u);
+
+  AppState state;
+  state.data.reset(std::move(source));
+  EXPECT_EQ(state.peek<uint32_t>(6), 0x09080706u);
+  EXPECT_EQ(state.data[39], 39);
+}
+
+TEST(DataSourceTest, CommandLineCacheOptions) {
+  const std::string path = write_temp_file("bin_reader_cli.bin", {0x00});
+  std::vector<std::string> args = {"bin-reader", "-f", path,
+                                   "--cache-mb", "8",  "--no-mmap"};
+  std::vector<char *> argv;
+  for (auto &arg : args)
+    argv.push_back(arg.data());
+
+  auto options =
+      Utils::ParseCommandLine(static_cast<int>(argv.size()), argv.data());
+  ASSERT_EQ(options.file_paths.size(), 1u);
+  EXPECT_EQ(options.file_paths[0], path);
+  EXPECT_EQ(options.open.cache_bytes, 8u << 20);
+  EXPECT_FALSE(options.open.use_mmap);
+
+  AppState state;
+  state.load_files(options.file_paths, options.open);
+  EXPECT_NE(dynamic_cast<const BlockCacheSource *>(state.data.source()),
+            nullptr);
+}
+
+TEST(DataSourceTest, AsyncLoadPublishesWholeFile) {
+  std::vector<uint8_t> bytes(5 * 1024 * 1024 + 3, 0x5A);
+  bytes.back() = 0x01;
+  const std::string path = write_temp_file("bin_reader_async.bin", bytes);
+
+  std::atomic<int> progress{0};
+  auto source = AsyncLoadSource::open(path, [&progress] { ++progress; });
+  ASSERT_NE(source, nullptr);
+  EXPECT_EQ(source->total_size(), bytes.size());
+
+  source->wait();
+  EXPECT_FALSE(source->loading());
+  EXPECT_EQ(source->size(), bytes.size());
+  EXPECT_GE(progress.load(), 2);
+
+  AppState state;
+  state.data.reset(std::move(source));
+  EXPECT_EQ(state.data[bytes.size() - 1], 0x01);
+  EXPECT_THROW(state.peek<uint32_t>(bytes.size() - 2), std::out_of_range);
+}
+
+namespace {
+// 模拟仍在加载中的数据源：只有前 4 字节可用
+class PendingSource : public DataSource {
+public:
+  size_t size() const override { return 4; }
+  size_t read(size_t pos, uint8_t *dst, size_t n) const override {
+    size_t done = 0;
+    for (; done < n && pos + done < 4; ++done)
+      dst[done] = static_cast<uint8_t>(pos + done);
+    return done;
+  }
+  bool loading() const override { return true; }
+};
+} // namespace
+
+TEST(DataSourceTest, ReadsBeyondLoadedPrefixReportPending) {
+  AppState state;
+  state.data.reset(std::make_shared<PendingSource>());
+  EXPECT_TRUE(state.data.loading());
+  EXPECT_EQ(state.peek<uint16_t>(2), 0x0302);
+  EXPECT_THROW(state.peek<uint32_t>(2), DataPendingError);
+  EXPECT_THROW(state.read_fixed_string(0, 8), DataPendingError);
+  EXPECT_EQ(state.cursor_pos, 0u);
+}
+
+TEST(DataSourceTest, FollowExtendsDataAndTracksTail) {
+  for (const bool use_mmap : {true, false}) {
+    const std::string path = write_temp_file("bin_reader_follow.bin",
+                                             {0x00, 0x01, 0x02, 0x03});
+    AppState state;
+    OpenOptions options;
+    options.use_mmap = use_mmap;
+    state.load_file(path, options);
+    ASSERT_EQ(state.data.size(), 4u);
+    EXPECT_EQ(state.data[3], 0x03); // 末尾块先进入缓存
+
+    state.follow_tail = true;
+    {
+      std::ofstream out(path, std::ios::binary | std::ios::app);
+      out.write("\x04\x05", 2);
+    }
+    EXPECT_EQ(state.refresh_data(), 2u);
+    EXPECT_EQ(state.data.size(), 6u);
+    EXPECT_EQ(state.data[5], 0x05);
+    EXPECT_EQ(state.cursor_pos, 5u);
+    EXPECT_EQ(state.refresh_data(), 0u);
+  }
+}
+
+TEST(DataSourceTest, FileWatcherReportsAppends) {
+  const std::string path = write_temp_file("bin_reader_watch.bin", {0x00});
+  std::atomic<int> changes{0};
+  FileWatcher watcher(path, [&changes] { ++changes; });
+
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (changes.load() == 0 && std::chrono::steady_clock::now() < deadline) {
+    {
+      std::ofstream out(path, std::ios::binary | std::ios::app);
+      out.put('\x01');
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  }
+  EXPECT_GT(changes.load(), 0);
+}
+
+#ifdef BIN_READER_WITH_ZLIB
+#include "GzipSource.hpp"
+#include <zlib.h>
+
+namespace {
+// 写入由两个 gzip 成员拼接而成的文件，返回解压后的原始内容
+std::vector<uint8_t> write_gzip_file(const std::string &path, size_t size) {
+  std::vector<uint8_t> plain(size);
+  uint32_t seed = 12345;
+  for (auto &byte : plain) {
+    seed = seed * 1103515245u + 12345u;
+    byte = static_cast<uint8_t>((seed >> 16) % 23);
+  }
+  std::filesystem::remove(path);
+  const size_t half = size / 2;
+  for (const auto &[from, to] : {std::pair{size_t{0}, half}, {half, size}}) {
+    gzFile gz = gzopen(path.c_str(), "ab");
+    gzwrite(gz, plain.data() + from, static_cast<unsigned>(to - from));
+    gzclose(gz);
+  }
+  return plain;
+}
+} // namespace
+
+TEST(DataSourceTest, GzipRandomAccessThroughCheckpoints) {
+  const std::string path =
+      (std::filesystem::temp_directory_path() / "bin_reader_gz.bin.gz")
+          .string();
+  std::filesystem::remove(GzipSource::sidecar_path(path));
+  const auto plain = write_gzip_file(path, 3 * 1024 * 1024 + 77);
+
+  for (const bool expect_sidecar : {false, true}) {
+    auto source = GzipSource::open(path, 256 * 1024, 256 * 1024, {});
+    ASSERT_NE(source, nullptr);
+    source->wait();
+    EXPECT_EQ(source->index_from_sidecar(), expect_sidecar);
+    ASSERT_EQ(source->size(), plain.size());
+    EXPECT_GT(source->checkpoints(), 4u);
+
+    // 倒序跳跃读取，迫使每次都从检查点重新开始解压
+    std::vector<uint8_t> buf(100);
+    for (size_t pos = plain.size() - 50; pos > 100; pos = pos * 2 / 3) {
+      const size_t got = source->read(pos, buf.data(), buf.size());
+      ASSERT_EQ(got, std::min<size_t>(100, plain.size() - pos)) << pos;
+      EXPECT_TRUE(std::equal(buf.begin(), buf.begin() + got,
+                             plain.begin() + static_cast<long>(pos)))
+          << "mismatch at " << pos;
+    }
+  }
+
+  // 默认检查点间隔与旁路索引不同，会在后台重新建立索引
+  AppState state;
+  state.load_file(path);
+  auto gz = dynamic_cast<const GzipSource *>(state.data.source());
+  ASSERT_NE(gz, nullptr);
+  gz->wait();
+  EXPECT_EQ(state.data.size(), plain.size());
+  EXPECT_EQ(state.data[plain.size() / 2], plain[plain.size() / 2]);
+}
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include "StreamSource.hpp"
+#include <unistd.h>
+
+TEST(DataSourceTest, StreamSpillsBeyondMemoryLimit) {
+  int fds[2];
+  ASSERT_EQ(pipe(fds), 0);
+
+  // 内存上限 1000 字节，其余落盘
+  auto source = StreamSource::from_fd(fds[0], 1000);
+  std::vector<uint8_t> bytes(5000);
+  for (size_t i = 0; i < bytes.size(); ++i)
+    bytes[i] = static_cast<uint8_t>(i * 7);
+  std::thread writer([&] {
+    for (size_t off = 0; off < bytes.size(); off += 700)
+      ASSERT_GT(write(fds[1], bytes.data() + off,
+                      std::min<size_t>(700, bytes.size() - off)),
+                0);
+    close(fds[1]);
+  });
+  source->wait();
+  writer.join();
+
+  EXPECT_FALSE(source->loading());
+  ASSERT_EQ(source->size(), bytes.size());
+  EXPECT_EQ(source->spilled_bytes(), 4000u);
+
+  // 跨越内存区与落盘区的读取
+  std::vector<uint8_t> buf(300);
+  EXPECT_EQ(source->read(900, buf.data(), buf.size()), 300u);
+  EXPECT_TRUE(std::equal(buf.begin(), buf.end(), bytes.begin() + 900));
+
+  AppState state;
+  state.data.reset(std::move(source));
+  EXPECT_EQ(state.data[4999], bytes[4999]);
+  EXPECT_THROW(state.peek<uint16_t>(4999), std::out_of_range);
+}
+
+TEST(DataSourceTest, CommandLineAcceptsStdin) {
+  std::vector<std::string> args = {"bin-reader", "-f", "-", "--mem-limit-mb",
+                                   "4"};
+  std::vector<char *> argv;
+  for (auto &arg : args)
+    argv.push_back(arg.data());
+
+  auto options =
+      Utils::ParseCommandLine(static_cast<int>(argv.size()), argv.data());
+  ASSERT_EQ(options.file_paths.size(), 1u);
+  EXPECT_EQ(options.file_paths[0], "-");
+  EXPECT_EQ(options.open.memory_limit, 4u << 20);
+  EXPECT_TRUE(StreamSource::is_stream("-"));
+  EXPECT_FALSE(StreamSource::is_stream("/dev/zero"));
+}
+#endif
+
+TEST(DataSourceTest, ExtentMapQueries) {
+  // 数据区段 [10,20) 与 [50,60)，总长 100
+  ExtentMap map({{10, 10}, {50, 10}}, 100);
+
+  auto hole = map.hole_at(0);
+  ASSERT_TRUE(hole.has_value());
+  EXPECT_EQ(hole->offset, 0u);
+  EXPECT_EQ(hole->end(), 10u);
+  EXPECT_FALSE(map.hole_at(15).has_value());
+  hole = map.hole_at(20);
+  ASSERT_TRUE(hole.has_value());
+  EXPECT_EQ(hole->offset, 20u);
+  EXPECT_EQ(hole->end(), 50u);
+  hole = map.hole_at(99);
+  ASSERT_TRUE(hole.has_value());
+  EXPECT_EQ(hole->end(), 100u);
+  EXPECT_FALSE(map.hole_at(100).has_value());
+
+  EXPECT_EQ(map.next_data(0), 10u);
+  EXPECT_EQ(map.next_data(10), 50u);
+  EXPECT_FALSE(map.next_data(50).has_value());
+
+  EXPECT_EQ(map.prev_data(70), 50u); // 空洞中：回到之前的区段
+  EXPECT_EQ(map.prev_data(55), 10u); // 区段中：回到前一个区段
+  EXPECT_FALSE(map.prev_data(15).has_value());
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+TEST(DataSourceTest, SparseFileNavigationSkipsHoles) {
+  const auto path =
+      (std::filesystem::temp_directory_path() / "bin_reader_sparse.bin")
+          .string();
+  constexpr size_t kMiB = 1024 * 1024;
+  {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write("HEAD", 4);
+    out.seekp(2 * kMiB);
+    out.write("DATA", 4);
+    out.seekp(4 * kMiB - 4);
+    out.write("TAIL", 4);
+  }
+
+  AppState state;
+  state.load_file(path);
+  auto extents = state.data.extents();
+  if (!extents)
+    GTEST_SKIP() << "filesystem does not report holes";
+
+  EXPECT_EQ(state.data.size(), 4 * kMiB);
+  EXPECT_TRUE(state.next_data());
+  EXPECT_GT(state.cursor_pos, 0u);
+  EXPECT_LE(state.cursor_pos, 2 * kMiB);
+  EXPECT_EQ(state.data[2 * kMiB], 'D');
+
+  // 翻页时跳过整页空洞（空洞按文件系统块对齐，起点不晚于 4 KiB）
+  const size_t page_bytes = state.bytes_per_line * state.hex_view_h;
+  state.set_cursor_pos(8192);
+  EXPECT_TRUE(state.next_page());
+  EXPECT_EQ(state.cursor_pos, 2 * kMiB);
+  EXPECT_TRUE(state.pre_page());
+  EXPECT_LE(state.current_page, 4096 / page_bytes);
+  EXPECT_LT(state.cursor_pos, 4096u);
+
+  // 分块缓存同样识别空洞，读取空洞直接得到 0
+  OpenOptions options;
+  options.use_mmap = false;
+  state.load_file(path, options);
+  ASSERT_NE(state.data.extents(), nullptr);
+  EXPECT_EQ(state.peek<uint32_t>(kMiB), 0u);
+  EXPECT_EQ(state.text(state.read_fixed_string(2 * kMiB, 4)), "DATA");
+}
+#endif
+
+TEST(DataSourceTest, ConcatenatedFilesReadAcrossSeams) {
+  // 长度前缀字符串 "hello world" 跨越 feed.0001 / feed.0002 的接缝
+  const std::string first =
+      write_temp_file("bin_reader_feed.0001.bin", {0xAA, 11, 0, 'h', 'e'});
+  const std::string second = write_temp_file(
+      "bin_reader_feed.0002.bin", {'l', 'l', 'o', ' ', 'w', 'o', 'r'});
+  const std::string third =
+      write_temp_file("bin_reader_feed.0003.bin", {'l', 'd', 0x34, 0x12});
+
+  AppState state;
+  state.load_files({first, second, third});
+  const auto *concat =
+      dynamic_cast<const ConcatSource *>(state.data.source());
+  ASSERT_NE(concat, nullptr);
+  EXPECT_EQ(concat->opened_segments(), 0u); // 打开时只读取文件大小
+  EXPECT_FALSE(concat->resident(0, 16));
+
+  ASSERT_EQ(state.data.size(), 16u);
+  ASSERT_NE(state.data.segments(), nullptr);
+  EXPECT_EQ((*state.data.segments())[1].offset, 5u);
+  EXPECT_EQ((*state.data.segments())[2].name, "bin_reader_feed.0003.bin");
+
+  state.cursor_pos = 1;
+  EXPECT_EQ(state.text(state.read_length_prefixed_string<uint16_t>(1)),
+            "hello world");
+  EXPECT_EQ(state.cursor_pos, 14u);
+  EXPECT_EQ(state.peek<uint16_t>(14), 0x1234);
+  EXPECT_EQ(state.segment_at(6)->name, "bin_reader_feed.0002.bin");
+  EXPECT_EQ(concat->opened_segments(), 3u);
+  EXPECT_TRUE(concat->resident(0, 16));
+}
+
+TEST(DataSourceTest, ConcatenatedSegmentDeletedAfterOpenReadsZero) {
+  const std::string first =
+      write_temp_file("bin_reader_gone.0001.bin", {'a', 'b'});
+  const std::string second =
+      write_temp_file("bin_reader_gone.0002.bin", {'c', 'd'});
+
+  AppState state;
+  state.load_files({first, second});
+  std::filesystem::remove(second);
+
+  // 渲染时的读取不抛异常，缺失的段按 0 补齐
+  uint8_t buf[4] = {1, 1, 1, 1};
+  EXPECT_EQ(state.data.read(0, buf, 4), 4u);
+  EXPECT_EQ(buf[1], 'b');
+  EXPECT_EQ(buf[2], 0);
+  EXPECT_EQ(buf[3], 0);
+
+  // 错误只报告一次，显示在状态栏
+  state.show_source_error();
+  EXPECT_NE(state.status_msg.find("bin_reader_gone.0002.bin"),
+            std::string::npos);
+  EXPECT_EQ(state.data.take_error(), "");
+}
+
+namespace {
+/// 记录收到的预读提示
+class AdviseRecorder : public MemorySource {
+public:
+  using MemorySource::MemorySource;
+  void advise(size_t pos, size_t n) const override {
+    advised.push_back(Extent{pos, n});
+  }
+  mutable std::vector<Extent> advised;
+};
+} // namespace
+
+TEST(DataSourceTest, PrefetcherDeepensWhileScrolling) {
+  Prefetcher prefetcher;
+  const auto t0 = Prefetcher::Clock::time_point{};
+  const auto fast = std::chrono::milliseconds(50);
+
+  // 第一次翻页只预读下一页
+  auto ahead = prefetcher.observe(CommandType::PageDown, 256, 256, 1 << 20, t0);
+  ASSERT_TRUE(ahead);
+  EXPECT_EQ(ahead->offset, 512u);
+  EXPECT_EQ(ahead->length, 256u);
+
+  // 连续翻页：深度增加，只返回尚未预读的部分
+  ahead = prefetcher.observe(CommandType::PageDown, 512, 256, 1 << 20,
+                             t0 + fast);
+  ASSERT_TRUE(ahead);
+  EXPECT_EQ(prefetcher.depth(), 2u);
+  EXPECT_EQ(ahead->offset, 768u);
+  EXPECT_EQ(ahead->length, 512u);
+
+  ahead = prefetcher.observe(CommandType::PageDown, 768, 256, 1 << 20,
+                             t0 + 2 * fast);
+  ASSERT_TRUE(ahead);
+  EXPECT_EQ(prefetcher.depth(), 3u);
+  EXPECT_EQ(ahead->offset, 1280u); // [1024, 1280) 已预读过
+  EXPECT_EQ(ahead->length, 512u);
+
+  // 换向后重新开始，向前预读
+  ahead = prefetcher.observe(CommandType::PageUp, 256, 256, 1 << 20,
+                             t0 + 3 * fast);
+  ASSERT_TRUE(ahead);
+  EXPECT_EQ(prefetcher.depth(), 1u);
+  EXPECT_EQ(ahead->offset, 0u);
+  EXPECT_EQ(ahead->length, 256u);
+
+  // 跳转与读取不触发预读
+  EXPECT_FALSE(prefetcher.observe(CommandType::Jump, 0, 256, 1 << 20));
+}
+
+TEST(DataSourceTest, ApplyCommandAdvisesNextPages) {
+  auto source =
+      std::make_shared<AdviseRecorder>(std::vector<uint8_t>(4096, 0x11));
+  AppState state;
+  state.data.reset(source);
+  state.bytes_per_line = 16;
+  state.hex_view_h = 4; // 一页 64 字节
+
+  state.apply_command(Command{CommandType::PageDown});
+  ASSERT_FALSE(source->advised.empty());
+  EXPECT_EQ(source->advised.back().offset, 128u);
+  EXPECT_EQ(source->advised.back().length, 64u);
+}
+
+#ifdef __linux__
+#include <thread>
+#include <unistd.h>
+
+TEST(DataSourceTest, ProcessMemoryReadsLiveValues) {
+  EXPECT_EQ(ProcMemSource::parse_pid("pid:1234"), 1234);
+  EXPECT_FALSE(ProcMemSource::parse_pid("pid:"));
+  EXPECT_FALSE(ProcMemSource::parse_pid("pid:12a"));
+
+  volatile uint64_t value = 0x1122334455667788ull;
+  const auto addr = reinterpret_cast<uintptr_t>(&value);
+
+  AppState state;
+  state.load_file(fmt::format("pid:{}", ::getpid()));
+  ASSERT_NE(state.data.extents(), nullptr);
+  EXPECT_GT(state.data.size(), addr);
+  EXPECT_TRUE(state.data.extents()->hole_at(0)); // 0 地址未映射
+  EXPECT_EQ(state.peek<uint64_t>(addr), 0x1122334455667788ull);
+  ASSERT_NE(state.segment_at(addr), nullptr);
+
+  // 页缓存过期后读到新值
+  value = 0x0102030405060708ull;
+  std::this_thread::sleep_for(ProcMemSource::kPageTtl +
+                              std::chrono::milliseconds(20));
+  EXPECT_EQ(state.peek<uint64_t>(addr), 0x0102030405060708ull);
+  EXPECT_FALSE(state.start_follow(false));
+}
+#endif
@@ -0,0 +1,285 @@
+#include "BlockStats.hpp"
+#include "ByteClass.hpp"
+#include "DataPreview.hpp"
+#include "FrameStats.hpp"
+#include "DataSource.hpp"
+#include "RowCache.hpp"
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// --------- RowCache 测试 ---------
+TEST(RowCacheTest, FormatsAddressHexAndAscii) {
+  DataBuffer data = {0x48, 0x69, 0x00, 0x7F, 0x41};
+  RowCache cache;
+
+  const FormattedRow &row = cache.row(data, 4, 4, 0, 8);
+  EXPECT_EQ(row.address, "00000004: ");
+  EXPECT_EQ(row.valid, 1u);
+  EXPECT_EQ(row.hex, "41 ");
+  EXPECT_EQ(row.ascii, "A");
+
+  const FormattedRow &first = cache.row(data, 0, 4, 0, 8);
+  EXPECT_EQ(first.hex, "48 69 00 7F ");
+  EXPECT_EQ(first.ascii, "Hi..");
+}
+
+TEST(RowCacheTest, ScrollingReformatsOnlyNewRows) {
+  DataBuffer data;
+  data.resize(1024, 0xAB);
+  RowCache cache;
+
+  // 第一帧：16 行全部格式化
+  for (size_t line = 0; line < 16; ++line)
+    cache.row(data, line * 16, 16, 0, 8);
+  EXPECT_EQ(cache.formatted(), 16u);
+
+  // 同一页再画一次（例如光标移动）：全部命中
+  for (size_t line = 0; line < 16; ++line)
+    cache.row(data, line * 16, 16, 0, 8);
+  EXPECT_EQ(cache.formatted(), 16u);
+
+  // 向下滚动一行：只有新露出的一行需要格式化
+  for (size_t line = 1; line < 17; ++line)
+    cache.row(data, line * 16, 16, 0, 8);
+  EXPECT_EQ(cache.formatted(), 17u);
+
+  // 显示模式或行宽变化时失效
+  cache.row(data, 16, 16, 1, 8);
+  cache.row(data, 16, 8, 0, 8);
+  EXPECT_EQ(cache.formatted(), 19u);
+}
+
+TEST(RowCacheTest, InvalidatesWhenDataChanges) {
+  DataBuffer data = {0x01, 0x02};
+  RowCache cache;
+  EXPECT_EQ(cache.row(data, 0, 4, 0, 8).valid, 2u);
+
+  // 替换数据源后版本号变化，旧行不会被复用
+  data = {0x03, 0x04, 0x05, 0x06};
+  const FormattedRow &row = cache.row(data, 0, 4, 0, 8);
+  EXPECT_EQ(row.valid, 4u);
+  EXPECT_EQ(row.hex, "03 04 05 06 ");
+  EXPECT_EQ(cache.formatted(), 2u);
+}
+
+// --------- DataPreview 测试 ---------
+TEST(RowCacheTest, ClassifiesBytesForColouring) {
+  DataBuffer data = {0x00, 'A', ' ', '\n', 0x01, 0x7F, 0x80, 0xFF};
+  RowCache cache;
+
+  const FormattedRow &row = cache.row(data, 0, 8, 0, 8);
+  const std::vector<uint8_t> expected = {
+      uint8_t(ByteClass::Zero),       uint8_t(ByteClass::Printable),
+      uint8_t(ByteClass::Whitespace), uint8_t(ByteClass::Whitespace),
+      uint8_t(ByteClass::Control),    uint8_t(ByteClass::Control),
+      uint8_t(ByteClass::HighBit),    uint8_t(ByteClass::Ones)};
+  EXPECT_EQ(row.classes, expected);
+
+  // 不着色时跳过分类；着色方式是缓存键的一部分
+  const FormattedRow &plain = cache.row(data, 0, 8, RowCache::kPlain, 8);
+  EXPECT_EQ(plain.classes, std::vector<uint8_t>(8, 0));
+  EXPECT_EQ(plain.hex, "00 41 20 0A 01 7F 80 FF ");
+  EXPECT_EQ(cache.formatted(), 2u);
+}
+
+TEST(ByteClassTest, VectorPathMatchesScalar) {
+  // 所有字节值，错开起点和长度以覆盖 32/16 字节分组与剩余部分
+  std::vector<uint8_t> bytes(3 * 256);
+  for (size_t i = 0; i < bytes.size(); ++i)
+    bytes[i] = static_cast<uint8_t>(i * 7);
+  for (size_t start : {0u, 1u, 15u, 33u}) {
+    for (size_t n : {0u, 5u, 16u, 31u, 64u, 700u}) {
+      n = std::min(n, bytes.size() - start);
+      std::vector<uint8_t> fast(n), slow(n);
+      classify_bytes(bytes.data() + start, fast.data(), n);
+      classify_bytes_scalar(bytes.data() + start, slow.data(), n);
+      EXPECT_EQ(fast, slow) << "start=" << start << " n=" << n;
+    }
+  }
+}
+
+TEST(DataPreviewTest, DecodesAllTypesFromOneLoad) {
+  DataBuffer data = {0x00, 0x00, 0x80, 0x3F, 0xFF, 0xFF, 0xFF, 0xFF, 0x01};
+  DataPreview preview;
+
+  EXPECT_TRUE(preview.update(data, 0, true));
+  const auto &values = preview.values();
+  EXPECT_EQ(values[0], "0");           // u8
+  EXPECT_EQ(values[2], "1065353216");  // u32
+  EXPECT_EQ(values[8], "1.000");       // f32
+  EXPECT_EQ(values[7], "-3229614080"); // i64 = 0xFFFFFFFF3F800000
+
+  // 大端序
+  EXPECT_TRUE(preview.update(data, 0, false));
+  EXPECT_EQ(values[1], "0");     // u16 = 0x0000
+  EXPECT_EQ(values[2], "32831"); // u32 = 0x0000803F
+
+  // 末尾不足 8 字节：放不下的类型显示 N/A
+  EXPECT_TRUE(preview.update(data, 7, true));
+  EXPECT_EQ(values[0], "255");
+  EXPECT_EQ(values[5], "511");
+  EXPECT_EQ(values[2], "N/A");
+  EXPECT_EQ(values[9], "N/A");
+}
+
+TEST(DataPreviewTest, RecomputesOnlyWhenInputsChange) {
+  DataBuffer data = {0x01, 0x02, 0x03, 0x04};
+  DataPreview preview;
+  EXPECT_TRUE(preview.update(data, 0, true));
+  EXPECT_FALSE(preview.update(data, 0, true));
+  EXPECT_FALSE(preview.update(data, 0, true));
+  EXPECT_EQ(preview.computed(), 1u);
+
+  EXPECT_TRUE(preview.update(data, 1, true)); // 光标移动
+  data = {0x05, 0x06};                        // 数据替换
+  EXPECT_TRUE(preview.update(data, 1, true));
+  EXPECT_EQ(preview.values()[0], "6");
+  EXPECT_EQ(preview.computed(), 3u);
+}
+
+// --------- BlockStats 测试 ---------
+TEST(BlockStatsTest, ClassifiesZeroTextAndRandomBlocks) {
+  constexpr size_t kBlock = 64 * 1024;
+  std::vector<uint8_t> bytes(3 * kBlock, 0);
+  const std::string line = "hello, world\n";
+  for (size_t i = 0; i < kBlock; ++i)
+    bytes[kBlock + i] = static_cast<uint8_t>(line[i % line.size()]);
+  uint32_t seed = 12345;
+  for (size_t i = 0; i < kBlock; ++i) {
+    seed = seed * 1664525u + 1013904223u;
+    bytes[2 * kBlock + i] = static_cast<uint8_t>(seed >> 24);
+  }
+
+  std::atomic<int> progress{0};
+  BlockStats stats(std::make_shared<MemorySource>(std::move(bytes)), 3,
+                   [&] { ++progress; }, 2);
+  stats.wait();
+  ASSERT_TRUE(stats.done());
+  EXPECT_GT(progress.load(), 0);
+
+  const BlockSummary zeros = stats.cell(0);
+  EXPECT_EQ(zeros.level, 2);
+  EXPECT_DOUBLE_EQ(zeros.zero_ratio, 1.0);
+  EXPECT_NEAR(zeros.entropy, 0.0, 0.05);
+
+  const BlockSummary text = stats.cell(1);
+  EXPECT_NEAR(text.printable_ratio, 1.0, 0.01);
+  EXPECT_NEAR(text.zero_ratio, 0.0, 0.01);
+
+  const BlockSummary random = stats.cell(2);
+  EXPECT_GT(random.entropy, 7.5);
+  EXPECT_LT(random.printable_ratio, 0.5);
+
+  // 区间平均
+  const BlockSummary all = stats.summary(0, 3);
+  EXPECT_NEAR(all.zero_ratio, (1.0 + random.zero_ratio) / 3, 0.01);
+}
+
+TEST(BlockStatsTest, MapsOffsetsToCells) {
+  BlockStats stats(std::make_shared<MemorySource>(std::vector<uint8_t>(1000)),
+                   7, {}, 1);
+  stats.wait();
+  EXPECT_EQ(stats.cell_offset(0), 0u);
+  EXPECT_EQ(stats.cell_offset(7), 1000u);
+  for (size_t i = 0; i < 7; ++i) {
+    EXPECT_EQ(stats.cell_at(stats.cell_offset(i)), i);
+    EXPECT_EQ(stats.cell_at(stats.cell_offset(i + 1) - 1), i);
+  }
+  EXPECT_EQ(stats.cell_at(5000), 6u);
+}
+
+namespace {
+/// 统计读取字节数；pos 落在 [fail_from, fail_to) 时抛出异常
+class ProbeSource : public MemorySource {
+public:
+  using MemorySource::MemorySource;
+  size_t read(size_t pos, uint8_t *dst, size_t n) const override {
+    if (pos >= fail_from && pos < fail_to)
+      throw std::runtime_error("Data source read error");
+    bytes_read += n;
+    return MemorySource::read(pos, dst, n);
+  }
+  size_t fail_from = 0, fail_to = 0;
+  mutable std::atomic<size_t> bytes_read{0};
+};
+} // namespace
+
+TEST(BlockStatsTest, MarksUnreadableBlocksInsteadOfTerminating) {
+  auto source = std::make_shared<ProbeSource>(std::vector<uint8_t>(4096, 'a'));
+  source->fail_from = 2048;
+  source->fail_to = 4096;
+  BlockStats stats(source, 4, {}, 2);
+  stats.wait();
+  ASSERT_TRUE(stats.done());
+  EXPECT_FALSE(stats.cell(0).unreadable);
+  EXPECT_EQ(stats.cell(0).level, 2);
+  EXPECT_TRUE(stats.cell(3).unreadable);
+  EXPECT_TRUE(stats.summary(0, 4).unreadable);
+}
+
+TEST(BlockStatsTest, GrowthReusesCellsInsideOldRange) {
+  constexpr size_t kOld = 1 << 20;
+  std::vector<uint8_t> bytes(kOld, 'x');
+  BlockStats before(std::make_shared<MemorySource>(bytes), 64, {}, 2);
+  before.wait();
+
+  // 末尾追加 1/8：旧范围内的块沿用结果，只读取跨过旧末尾的块
+  bytes.resize(kOld + kOld / 8, 0);
+  auto grown = std::make_shared<ProbeSource>(bytes);
+  BlockStats after(grown, 64, {}, 2, &before);
+  after.wait();
+  EXPECT_LT(grown->bytes_read.load(), kOld / 4);
+  EXPECT_NEAR(after.cell(0).printable_ratio, 1.0, 0.01);
+  EXPECT_EQ(after.cell(0).level, 2);
+  EXPECT_NEAR(after.cell(63).zero_ratio, 1.0, 0.01);
+}
+
+// --------- FrameStats 测试 ---------
+TEST(FrameStatsTest, RecordsSectionsAllocationsAndPercentiles) {
+  FrameStats &perf = FrameStats::instance();
+  perf.set_enabled(true);
+
+  // 每帧统计分配次数与分项
+  for (int i = 1; i <= 100; ++i) {
+    perf.begin_frame();
+    auto boxed = std::make_unique<int>(i);
+    perf.add_time(FrameSection::HexView, std::chrono::milliseconds(i));
+    perf.add_elements(FrameSection::HexView, 3);
+    perf.end_frame();
+  }
+  EXPECT_EQ(perf.frames(), 100u);
+  if (FrameStats::counts_allocations())
+    EXPECT_GE(perf.last().allocations, 1u);
+  else
+    EXPECT_EQ(perf.last().allocations, 0u);
+  EXPECT_DOUBLE_EQ(perf.last().ms[size_t(FrameSection::HexView)], 100.0);
+  EXPECT_EQ(perf.last().elements[size_t(FrameSection::HexView)], 3u);
+  EXPECT_LE(perf.percentile(50), perf.percentile(99));
+
+  // 帧外的统计不计入
+  perf.add_elements(FrameSection::History, 5);
+  EXPECT_EQ(perf.last().elements[size_t(FrameSection::History)], 0u);
+
+  const auto path =
+      std::filesystem::temp_directory_path() / "bin_reader_perf_test.csv";
+  ASSERT_TRUE(perf.dump(path.string()));
+  std::ifstream in(path);
+  size_t lines = 0;
+  for (std::string line; std::getline(in, line);)
+    ++lines;
+  EXPECT_EQ(lines, 1u + 100u + 2u); // 表头 + 每帧一行 + p50/p99
+  std::filesystem::remove(path);
+
+  perf.set_enabled(false);
+  perf.begin_frame();
+  perf.end_frame();
+  EXPECT_EQ(perf.frames(), 100u);
+}
@@ -29,4 +29,15 @@ TEST_F(UIComponentsTest, HexViewRendersAddressAndData) {
                                                          << output;
 
   std::cout << output << std::endl;
-}
\ No newline at end of file
+}
+TEST_F(UIComponentsTest, HexViewPaintsHexAndAsciiColumns) {
+  state.data = {0x48, 0x65, 0x6C, 0x6C, 0x6F, 0x00};
+  state.bytes_per_line = 4;
+
+  const std::string output = RenderHexView();
+
+  EXPECT_NE(output.find("48 65 6C 6C"), std::string::npos) << output;
+  EXPECT_NE(output.find("Hell"), std::string::npos) << output;
+  EXPECT_NE(output.find("00000004: 6F 00"), std::string::npos) << output;
+  EXPECT_NE(output.find("o."), std::string::npos) << output;
+}